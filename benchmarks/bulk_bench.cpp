@@ -0,0 +1,75 @@
+// Bulk insertion into recycled IDs: 100K 16-byte elements per tick, erased again after each, as a
+// push_back() loop, with emplace_n(), with emplace_n() and siv::default_init_allocator, and with
+// insert_range(). Best of 50 ticks.
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct particle
+    {
+        float x = 0;
+        float y = 0;
+        float z = 0;
+        float w = 0;
+    };
+
+    constexpr std::size_t batch_size = 100'000;
+    constexpr int         tick_count = 50;
+
+    /// Best time of `insert(vec, ids)` into a vector whose IDs were all erased the tick before, in us
+    template<typename Vector, typename Insert>
+    double tick_us(Insert&& insert)
+    {
+        Vector vec;
+        std::vector<siv::id_type> ids(batch_size);
+        double best = 1e300;
+        for (int r = 0; r < tick_count; ++r) {
+            const auto start = clock_type::now();
+            insert(vec, ids);
+            const std::chrono::duration<double, std::micro> elapsed = clock_type::now() - start;
+            best = std::min(best, elapsed.count());
+            for (const siv::id_type id : ids) {
+                vec.erase(id);
+            }
+        }
+        return best;
+    }
+}
+
+int main()
+{
+    using vector_type        = siv::vector<particle>;
+    using uninit_vector_type = siv::vector<particle, siv::default_init_allocator<particle>>;
+
+    const std::vector<particle> wave(batch_size, particle{1, 2, 3, 4});
+
+    std::printf("%zu elements of %zu bytes per tick, best of %d (us)\n", batch_size, sizeof(particle), tick_count);
+    std::printf("%-36s %8.0f\n", "push_back loop", tick_us<vector_type>([](vector_type& vec, std::vector<siv::id_type>& ids) {
+        for (siv::id_type& id : ids) {
+            id = vec.push_back(particle{});
+        }
+    }));
+    std::printf("%-36s %8.0f\n", "emplace_n", tick_us<vector_type>([](vector_type& vec, std::vector<siv::id_type>& ids) {
+        vec.emplace_n(ids.size(), ids);
+    }));
+    std::printf("%-36s %8.0f\n", "emplace_n, default_init_allocator",
+                tick_us<uninit_vector_type>([](uninit_vector_type& vec, std::vector<siv::id_type>& ids) {
+                    vec.emplace_n(ids.size(), ids);
+                }));
+    std::printf("%-36s %8.0f\n", "push_back loop, copies", tick_us<vector_type>([&](vector_type& vec, std::vector<siv::id_type>& ids) {
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            ids[i] = vec.push_back(wave[i]);
+        }
+    }));
+    std::printf("%-36s %8.0f\n", "insert_range", tick_us<vector_type>([&](vector_type& vec, std::vector<siv::id_type>& ids) {
+        vec.insert_range(wave, ids);
+    }));
+    return 0;
+}
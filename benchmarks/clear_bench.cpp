@@ -0,0 +1,62 @@
+// clear() on a nearly empty vector that once held many IDs: 1000 live ints among 1M to 20M
+// allocated IDs, average of 20 clears. The cost should follow the live elements, not the IDs
+// ever allocated; with a FIFO recycling queue it is O(size).
+// Usage: clear_bench [largest ID count]
+#include "index_vector.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    constexpr std::size_t live_count  = 1000;
+    constexpr int         clear_count = 20;
+
+    /// Average time of one clear() with `live_count` live elements and `id_count` allocated IDs, in us
+    template<typename Traits>
+    double clear_us(std::size_t id_count)
+    {
+        using vector_type = siv::vector<int, std::allocator<int>, Traits>;
+        using id_type     = typename vector_type::id_type;
+
+        vector_type vec;
+        std::vector<id_type> ids;
+        ids.reserve(id_count);
+        for (std::size_t i = 0; i < id_count; ++i) {
+            ids.push_back(vec.push_back(static_cast<int>(i)));
+        }
+        for (std::size_t i = live_count; i < ids.size(); ++i) {
+            vec.erase(ids[i]);
+        }
+        vec.clear();
+
+        double total = 0;
+        for (int r = 0; r < clear_count; ++r) {
+            for (std::size_t i = 0; i < live_count; ++i) {
+                (void)vec.push_back(static_cast<int>(i));
+            }
+            const auto start = clock_type::now();
+            vec.clear();
+            const std::chrono::duration<double, std::micro> elapsed = clock_type::now() - start;
+            total += elapsed.count();
+        }
+        return total / clear_count;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t largest = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t{20'000'000};
+
+    std::printf("clear() with %zu live elements, average of %d (us)\n", live_count, clear_count);
+    std::printf("%12s %10s %10s\n", "IDs", "default", "fifo");
+    for (std::size_t id_count : {largest / 20, largest / 5, largest}) {
+        std::printf("%12zu %10.2f %10.2f\n", id_count, clear_us<siv::default_traits>(id_count),
+                    clear_us<siv::recycling_traits<siv::recycle_policy::fifo>>(id_count));
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Handle validation with and without colocated_generation: 8M handles into a vector of 8M 16-byte
+// elements that has been half erased and refilled, resolved with handle::get() in shuffled order,
+// once as independent lookups and once as a dependent chain, where each element names the next
+// handle to follow. The chain exposes the full latency of each lookup.
+// Usage: coloc_bench [element count]
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct link
+    {
+        std::uint64_t next  = 0;
+        std::uint64_t value = 0;
+    };
+
+    template<typename Base>
+    struct colocated : Base
+    {
+        static constexpr bool colocated_generation = true;
+    };
+
+    constexpr int repeats = 3;
+
+    volatile std::uint64_t sink;
+
+    template<typename Run>
+    double best_ms(Run&& run)
+    {
+        double best = 1e300;
+        for (int r = 0; r < repeats; ++r) {
+            const auto start = clock_type::now();
+            run();
+            const std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    template<typename Traits>
+    void run(const char* name, std::size_t element_count)
+    {
+        using vector_type = siv::vector<link, std::allocator<link>, Traits>;
+        using handle_type = typename vector_type::handle_type;
+
+        vector_type vec;
+        std::mt19937_64 rng(7);
+        for (std::size_t i = 0; i < element_count; ++i) {
+            (void)vec.push_back(link{0, i});
+        }
+        // Scatter the IDs over the data, as after a while of erasures and insertions
+        for (std::size_t i = 0; i < element_count / 2; ++i) {
+            vec.erase_at(rng() % vec.size());
+        }
+        for (std::size_t i = 0; i < element_count / 2; ++i) {
+            (void)vec.push_back(link{0, i});
+        }
+        std::vector<handle_type> handles;
+        handles.reserve(vec.size());
+        for (std::size_t i = 0; i < vec.size(); ++i) {
+            handles.push_back(vec.make_handle_at(i));
+        }
+        std::shuffle(handles.begin(), handles.end(), rng);
+        // One cycle through all handles, in random order
+        for (std::size_t i = 0; i < handles.size(); ++i) {
+            handles[i].get()->next = (i + 1) % handles.size();
+        }
+
+        const double independent_ms = best_ms([&] {
+            std::uint64_t sum = 0;
+            for (const handle_type& h : handles) {
+                if (const link* l = h.get()) {
+                    sum += l->value;
+                }
+            }
+            sink = sum;
+        });
+        const double chain_ms = best_ms([&] {
+            std::uint64_t at = 0;
+            for (std::size_t i = 0; i < handles.size(); ++i) {
+                at = handles[at].get()->next;
+            }
+            sink = at;
+        });
+        const double n = static_cast<double>(handles.size());
+        std::printf("%-24s %14.1f %14.1f\n", name, independent_ms * 1e6 / n, chain_ms * 1e6 / n);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t element_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t{1} << 23;
+
+    std::printf("handle::get() on %zu elements, best of %d (ns per lookup)\n", element_count, repeats);
+    std::printf("%-24s %14s %14s\n", "traits", "independent", "chained");
+    run<siv::default_traits>("default", element_count);
+    run<colocated<siv::default_traits>>("default, colocated", element_count);
+    run<siv::compact_traits>("compact", element_count);
+    run<colocated<siv::compact_traits>>("compact, colocated", element_count);
+    return 0;
+}
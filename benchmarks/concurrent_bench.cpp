@@ -0,0 +1,88 @@
+// Contended appends: 4M pushes of a 16-byte struct, split over 1 to 64 threads, into a
+// siv::vector behind a std::mutex and into a siv::concurrent_vector. A mutex serializes every
+// writer, while a concurrent push only shares the claim counter.
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct particle
+    {
+        float         x = 0;
+        float         y = 0;
+        std::uint64_t tag = 0;
+    };
+    static_assert(sizeof(particle) == 16);
+
+    constexpr std::size_t total_pushes = std::size_t{1} << 22;
+    constexpr int         repeats      = 3;
+
+    /// Best of a few runs of `push(thread_index, count)` on `threads` threads, in milliseconds
+    template<typename Setup, typename Push>
+    double best_ms(int threads, Setup&& setup, Push&& push)
+    {
+        double best = 1e300;
+        for (int r = 0; r < repeats; ++r) {
+            setup();
+            std::atomic<bool> start{false};
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    while (!start.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    push(t, total_pushes / static_cast<std::size_t>(threads));
+                });
+            }
+            const auto begin = clock_type::now();
+            start.store(true, std::memory_order_release);
+            for (std::thread& w : workers) {
+                w.join();
+            }
+            const std::chrono::duration<double, std::milli> elapsed = clock_type::now() - begin;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+}
+
+int main()
+{
+    std::printf("hardware_concurrency: %u, %zu pushes of %zu bytes, best of %d\n",
+                std::thread::hardware_concurrency(), total_pushes, sizeof(particle), repeats);
+    std::printf("%8s %22s %20s\n", "threads", "mutex + siv::vector", "concurrent_vector");
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        std::mutex mutex;
+        std::unique_ptr<siv::vector<particle>> locked;
+        const double locked_ms = best_ms(
+            threads, [&] { locked = std::make_unique<siv::vector<particle>>(); },
+            [&](int t, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const std::lock_guard<std::mutex> lock(mutex);
+                    (void)locked->push_back({1.0f, 2.0f, static_cast<std::uint64_t>(t)});
+                }
+            });
+
+        std::unique_ptr<siv::concurrent_vector<particle>> concurrent;
+        const double concurrent_ms = best_ms(
+            threads, [&] { concurrent = std::make_unique<siv::concurrent_vector<particle>>(); },
+            [&](int t, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    (void)concurrent->push_back({1.0f, 2.0f, static_cast<std::uint64_t>(t)});
+                }
+            });
+        std::printf("%8d %22.1f %20.1f\n", threads, locked_ms, concurrent_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Reads during writes: 4M random lookups among 100K objects, split over 1 to 16 reader threads,
+// while one writer erases and inserts in a loop. Compares a siv::vector behind a
+// std::shared_mutex, siv::optimistic_vector, and siv::epoch_vector pinned per lookup or per
+// 1024 lookups; the epoch writer publishes every 64 changes.
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct body
+    {
+        float x  = 0;
+        float y  = 0;
+        float vx = 0;
+        float vy = 0;
+    };
+
+    constexpr std::size_t object_count  = 100'000;
+    constexpr std::size_t total_lookups = std::size_t{1} << 22;
+    constexpr std::size_t pin_batch     = 1024;
+    constexpr std::size_t publish_every = 64;
+    constexpr int         repeats       = 3;
+
+    std::atomic<std::uint64_t> sink{0};
+
+    /** Fills the container with `add`, then times `readers` threads each running
+     *  `read(thread, lookups)` while one thread runs `churn(rng)` in a loop. Best of a few runs, in ms.
+     */
+    template<typename Make, typename Churn, typename Read>
+    double best_ms(int readers, Make&& make, Churn&& churn, Read&& read)
+    {
+        double best = 1e300;
+        for (int r = 0; r < repeats; ++r) {
+            auto container = make();
+            std::atomic<bool> start{false};
+            std::atomic<bool> stop{false};
+            std::thread writer([&] {
+                std::mt19937 rng(42);
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                while (!stop.load(std::memory_order_relaxed)) {
+                    churn(*container, rng);
+                }
+            });
+            std::vector<std::thread> threads;
+            for (int t = 0; t < readers; ++t) {
+                threads.emplace_back([&, t] {
+                    while (!start.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    read(*container, t, total_lookups / static_cast<std::size_t>(readers));
+                });
+            }
+            const auto begin = clock_type::now();
+            start.store(true, std::memory_order_release);
+            for (std::thread& t : threads) {
+                t.join();
+            }
+            const std::chrono::duration<double, std::milli> elapsed = clock_type::now() - begin;
+            stop.store(true, std::memory_order_relaxed);
+            writer.join();
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    /// Random IDs in the live range; erasures and insertions recycle IDs, so it stays dense
+    struct id_stream
+    {
+        std::uint64_t state;
+
+        explicit id_stream(int seed) : state{static_cast<std::uint64_t>(seed) * 0x9E3779B97F4A7C15ull + 1} {}
+
+        std::size_t next()
+        {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            return static_cast<std::size_t>((state >> 33) % object_count);
+        }
+    };
+
+    struct locked
+    {
+        std::shared_mutex         mutex;
+        siv::vector<body>         vec;
+        std::vector<siv::id_type> ids;
+    };
+
+    struct optimistic
+    {
+        siv::optimistic_vector<body> vec;
+        std::vector<siv::id_type>    ids;
+    };
+
+    struct epoch
+    {
+        siv::epoch_vector<body, 32> vec;
+        std::vector<siv::id_type>   ids;
+        std::size_t                 changes = 0;
+    };
+
+    template<typename Container, typename Add>
+    std::unique_ptr<Container> fill(Add&& add)
+    {
+        auto c = std::make_unique<Container>();
+        for (std::size_t i = 0; i < object_count; ++i) {
+            c->ids.push_back(add(*c, body{static_cast<float>(i), 0, 0, 0}));
+        }
+        return c;
+    }
+}
+
+int main()
+{
+    std::printf("hardware_concurrency: %u, %zu lookups among %zu objects, best of %d (ms)\n",
+                std::thread::hardware_concurrency(), total_lookups, object_count, repeats);
+    std::printf("%8s %14s %12s %18s %18s\n", "readers", "shared_mutex", "optimistic", "epoch, pin/lookup", "epoch, pin/1024");
+    for (int readers : {1, 4, 16}) {
+        const double locked_ms = best_ms(
+            readers,
+            [] { return fill<locked>([](locked& c, const body& b) { return c.vec.push_back(b); }); },
+            [](locked& c, std::mt19937& rng) {
+                const std::unique_lock<std::shared_mutex> lock(c.mutex);
+                siv::id_type& id = c.ids[rng() % c.ids.size()];
+                c.vec.erase(id);
+                id = c.vec.push_back(body{1, 2, 3, 4});
+            },
+            [](locked& c, int t, std::size_t lookups) {
+                id_stream ids(t);
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0; i < lookups; ++i) {
+                    const std::shared_lock<std::shared_mutex> lock(c.mutex);
+                    const siv::id_type id = static_cast<siv::id_type>(ids.next());
+                    if (c.vec.contains(id)) {
+                        sum += static_cast<std::uint64_t>(c.vec[id].x);
+                    }
+                }
+                sink.fetch_add(sum, std::memory_order_relaxed);
+            });
+
+        const double optimistic_ms = best_ms(
+            readers,
+            [] { return fill<optimistic>([](optimistic& c, const body& b) { return c.vec.push_back(b); }); },
+            [](optimistic& c, std::mt19937& rng) {
+                siv::id_type& id = c.ids[rng() % c.ids.size()];
+                c.vec.erase(id);
+                id = c.vec.push_back(body{1, 2, 3, 4});
+            },
+            [](optimistic& c, int t, std::size_t lookups) {
+                id_stream ids(t);
+                std::uint64_t sum = 0;
+                body b;
+                for (std::size_t i = 0; i < lookups; ++i) {
+                    if (c.vec.load(static_cast<siv::id_type>(ids.next()), b)) {
+                        sum += static_cast<std::uint64_t>(b.x);
+                    }
+                }
+                sink.fetch_add(sum, std::memory_order_relaxed);
+            });
+
+        auto make_epoch = [] {
+            auto c = fill<epoch>([](epoch& e, const body& b) { return e.vec.push_back(b); });
+            c->vec.publish();
+            return c;
+        };
+        auto churn_epoch = [](epoch& c, std::mt19937& rng) {
+            siv::id_type& id = c.ids[rng() % c.ids.size()];
+            c.vec.erase(id);
+            id = c.vec.push_back(body{1, 2, 3, 4});
+            if (++c.changes % publish_every == 0) {
+                c.vec.publish();
+            }
+        };
+        auto read_epoch = [](std::size_t batch) {
+            return [batch](epoch& c, int t, std::size_t lookups) {
+                siv::epoch_vector<body, 32>::reader reader(c.vec);
+                id_stream ids(t);
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0; i < lookups; i += batch) {
+                    const auto view = reader.read();
+                    for (std::size_t j = i; j < std::min(i + batch, lookups); ++j) {
+                        if (const body* b = view.find(static_cast<siv::id_type>(ids.next()))) {
+                            sum += static_cast<std::uint64_t>(b->x);
+                        }
+                    }
+                }
+                sink.fetch_add(sum, std::memory_order_relaxed);
+            };
+        };
+        const double epoch_each_ms  = best_ms(readers, make_epoch, churn_epoch, read_epoch(1));
+        const double epoch_batch_ms = best_ms(readers, make_epoch, churn_epoch, read_epoch(pin_batch));
+
+        std::printf("%8d %14.1f %12.1f %18.1f %18.1f\n", readers, locked_ms, optimistic_ms, epoch_each_ms, epoch_batch_ms);
+    }
+    return 0;
+}
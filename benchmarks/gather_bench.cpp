@@ -0,0 +1,109 @@
+// Batch lookups above the last-level cache: 1M random IDs into a vector of 20M 64-byte elements
+// (about 2.5 GB with the ID tables), as a loop of operator[] and as for_each(ids), with 0, 4 and
+// 16 hash rounds of work per element, and gather_values() against a copy loop.
+// Usage: gather_bench [element count]
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct entity
+    {
+        std::uint64_t key = 0;
+        std::uint64_t payload[7] = {};
+    };
+    static_assert(sizeof(entity) == 64);
+
+    constexpr std::size_t lookup_count = std::size_t{1} << 20;
+    constexpr int         repeats      = 3;
+
+    volatile std::uint64_t sink;
+
+    /// `rounds` rounds of a multiply-xorshift mix: per-element work the CPU cannot skip
+    inline std::uint64_t work(std::uint64_t x, int rounds)
+    {
+        for (int r = 0; r < rounds; ++r) {
+            x ^= x >> 29;
+            x *= 0xBF58476D1CE4E5B9ull;
+        }
+        return x;
+    }
+
+    template<typename Run>
+    double best_ms(Run&& run)
+    {
+        double best = 1e300;
+        for (int r = 0; r < repeats; ++r) {
+            const auto start = clock_type::now();
+            run();
+            const std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t element_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t{20'000'000};
+
+    siv::vector<entity> vec;
+    vec.reserve(element_count);
+    std::vector<siv::id_type> all;
+    all.reserve(element_count);
+    for (std::size_t i = 0; i < element_count; ++i) {
+        all.push_back(vec.push_back(entity{i, {}}));
+    }
+    std::mt19937_64 rng(1);
+    std::vector<siv::id_type> ids(lookup_count);
+    for (siv::id_type& id : ids) {
+        id = all[rng() % all.size()];
+    }
+    // Shuffle the data order too, so that neither table is walked in ID order
+    std::vector<std::size_t> perm(element_count);
+    for (std::size_t i = 0; i < element_count; ++i) {
+        perm[i] = i;
+    }
+    std::shuffle(perm.begin(), perm.end(), rng);
+    vec.apply_permutation(perm);
+
+    std::printf("%zu lookups into %zu elements of %zu bytes, best of %d (ms)\n",
+                lookup_count, element_count, sizeof(entity), repeats);
+    std::printf("%-26s %12s %14s\n", "work per element", "operator[]", "for_each(ids)");
+    for (int rounds : {0, 4, 16}) {
+        const double loop_ms = best_ms([&] {
+            std::uint64_t sum = 0;
+            for (const siv::id_type id : ids) {
+                sum += work(vec[id].key, rounds);
+            }
+            sink = sum;
+        });
+        const double batch_ms = best_ms([&] {
+            std::uint64_t sum = 0;
+            vec.for_each(ids, [&](const entity& e) { sum += work(e.key, rounds); });
+            sink = sum;
+        });
+        std::printf("%2d hash rounds %23.1f %14.1f\n", rounds, loop_ms, batch_ms);
+    }
+
+    std::vector<entity> copies(lookup_count);
+    const double copy_ms = best_ms([&] {
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            copies[i] = vec[ids[i]];
+        }
+    });
+    const double gather_ms = best_ms([&] {
+        vec.gather_values(ids, copies);
+    });
+    std::printf("%-26s %12.1f %14.1f\n", "copy (gather_values)", copy_ms, gather_ms);
+    return 0;
+}
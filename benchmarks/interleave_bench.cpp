@@ -0,0 +1,104 @@
+// Interleaved coroutine lookups against the prefetching pipeline: 2M random IDs into a vector of
+// 100M uint64_t (compact_traits, about 2 GB with the ID tables), with a callback doing a varying
+// number of hash rounds per element. Compares a loop of operator[], for_each(ids) and
+// siv::experimental::for_each_interleaved() with groups of 8, 16 and 32. Needs C++20 coroutines.
+// Usage: interleave_bench [element count]
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#if SIV_COROUTINES
+namespace
+{
+    using clock_type  = std::chrono::steady_clock;
+    using vector_type = siv::vector<std::uint64_t, std::allocator<std::uint64_t>, siv::compact_traits>;
+    using id_type     = vector_type::id_type;
+
+    constexpr std::size_t lookup_count = 2'000'000;
+    constexpr int         repeats      = 3;
+
+    volatile std::uint64_t sink;
+
+    /// x % max_rounds rounds of a multiply-xorshift mix: work that varies from element to element
+    inline std::uint64_t work(std::uint64_t x, unsigned max_rounds)
+    {
+        const unsigned rounds = static_cast<unsigned>(x % max_rounds);
+        for (unsigned r = 0; r < rounds; ++r) {
+            x = (x ^ (x >> 31)) * 0x7FB5D329728EA185ull;
+        }
+        return x;
+    }
+
+    template<typename Run>
+    double best_ms(Run&& run)
+    {
+        double best = 1e300;
+        for (int r = 0; r < repeats; ++r) {
+            const auto start = clock_type::now();
+            run();
+            const std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t element_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t{100'000'000};
+
+    vector_type vec;
+    vec.reserve(element_count);
+    std::mt19937_64 rng(1);
+    for (std::size_t i = 0; i < element_count; ++i) {
+        (void)vec.push_back(rng());
+    }
+    std::vector<id_type> ids(lookup_count);
+    for (id_type& id : ids) {
+        id = static_cast<id_type>(rng() % element_count);
+    }
+    const vector_type& cvec = vec;
+
+    std::printf("%zu lookups into %zu elements, best of %d (ms)\n", lookup_count, element_count, repeats);
+    std::printf("%-14s %10s %14s %12s %12s %12s\n", "hash rounds", "operator[]", "for_each(ids)",
+                "group 8", "group 16", "group 32");
+    for (unsigned max_rounds : {1u, 8u, 32u}) {
+        const double loop_ms = best_ms([&] {
+            std::uint64_t sum = 0;
+            for (const id_type id : ids) {
+                sum += work(cvec[id], max_rounds);
+            }
+            sink = sum;
+        });
+        const double batch_ms = best_ms([&] {
+            std::uint64_t sum = 0;
+            cvec.for_each(ids, [&](std::uint64_t x) { sum += work(x, max_rounds); });
+            sink = sum;
+        });
+        double interleaved_ms[3];
+        std::size_t g = 0;
+        for (std::size_t group : {std::size_t{8}, std::size_t{16}, std::size_t{32}}) {
+            interleaved_ms[g++] = best_ms([&] {
+                std::uint64_t sum = 0;
+                siv::experimental::for_each_interleaved(cvec, ids, [&](std::uint64_t x) { sum += work(x, max_rounds); }, group);
+                sink = sum;
+            });
+        }
+        std::printf("0 to %-9u %10.1f %14.1f %12.1f %12.1f %12.1f\n", max_rounds - 1, loop_ms, batch_ms,
+                    interleaved_ms[0], interleaved_ms[1], interleaved_ms[2]);
+    }
+    return 0;
+}
+#else
+int main()
+{
+    std::puts("interleave_bench needs C++20 coroutines");
+    return 0;
+}
+#endif
@@ -0,0 +1,88 @@
+// Sequential against siv::execution::par: for_each, transform_reduce, erase_if and sort over a
+// range of sizes, on uint64_t elements with cheap per-element work. The parallel overloads only
+// pay off where the par column is the smaller one; SIV_PARALLEL_GRAIN is the size per thread
+// below which they stay on the calling thread.
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using clock_type  = std::chrono::steady_clock;
+    using vector_type = siv::vector<std::uint64_t>;
+
+    /// Best of a few runs of `run` on a vector freshly filled with `values`, in milliseconds
+    template<typename Run>
+    double best_ms(const std::vector<std::uint64_t>& values, int repeats, Run&& run)
+    {
+        double best = 1e300;
+        for (int r = 0; r < repeats; ++r) {
+            vector_type vec;
+            vec.reserve(values.size());
+            for (const std::uint64_t value : values) {
+                (void)vec.push_back(value);
+            }
+            const auto start = clock_type::now();
+            run(vec);
+            const std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    template<typename Serial, typename Parallel>
+    void report(const char* name, const std::vector<std::uint64_t>& values, int repeats, Serial&& serial, Parallel&& parallel)
+    {
+        const double seq = best_ms(values, repeats, serial);
+        const double par = best_ms(values, repeats, parallel);
+        std::printf("%-18s %10zu %12.3f %12.3f %8.2fx\n", name, values.size(), seq, par, seq / par);
+    }
+
+    volatile std::uint64_t sink;
+}
+
+int main()
+{
+    std::printf("hardware_concurrency: %u, SIV_PARALLEL_GRAIN: %zu\n",
+                std::thread::hardware_concurrency(), static_cast<std::size_t>(siv::detail::parallel_grain));
+    std::printf("%-18s %10s %12s %12s %9s\n", "operation", "size", "seq ms", "par ms", "speedup");
+
+    std::mt19937_64 rng(1);
+    for (std::size_t size : {std::size_t{1} << 12, std::size_t{1} << 15, std::size_t{1} << 18,
+                             std::size_t{1} << 21, std::size_t{1} << 23}) {
+        std::vector<std::uint64_t> values(size);
+        for (std::uint64_t& value : values) {
+            value = rng();
+        }
+        const int repeats = size < (std::size_t{1} << 20) ? 20 : 3;
+
+        report("for_each", values, repeats,
+               [](vector_type& v) { v.for_each([](std::uint64_t& x) { x = x * 3 + 1; }); },
+               [](vector_type& v) { v.for_each(siv::execution::par, [](std::uint64_t& x) { x = x * 3 + 1; }); });
+        report("transform_reduce", values, repeats,
+               [](vector_type& v) {
+                   sink = v.transform_reduce(std::uint64_t{0}, std::plus<>{}, [](std::uint64_t x) { return x >> 3; });
+               },
+               [](vector_type& v) {
+                   sink = v.transform_reduce(siv::execution::par, std::uint64_t{0}, std::plus<>{},
+                                             [](std::uint64_t x) { return x >> 3; });
+               });
+        report("erase_if", values, repeats,
+               [](vector_type& v) { v.erase_if([](std::uint64_t x) { return x % 10 < 3; }); },
+               [](vector_type& v) { v.erase_if(siv::execution::par, [](std::uint64_t x) { return x % 10 < 3; }); });
+        report("erase_if noexcept", values, repeats,
+               [](vector_type& v) { v.erase_if([](std::uint64_t x) noexcept { return x % 10 < 3; }); },
+               [](vector_type& v) { v.erase_if(siv::execution::par, [](std::uint64_t x) noexcept { return x % 10 < 3; }); });
+        report("sort", values, repeats,
+               [](vector_type& v) { v.sort(); },
+               [](vector_type& v) { v.sort(siv::execution::par); });
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Relocating storage against the default std::vector storage, for 64- and 256-byte trivially
+// copyable elements and a 64-byte owning type marked trivially relocatable. On 1M elements: growth
+// by emplace_back(), erasing half in random order, sort(), and compact() of a tombstoned vector
+// with every other element erased. Then 4M erase/insert pairs on 2048 elements, in cache.
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template<std::size_t Bytes>
+    struct pod
+    {
+        long payload[Bytes / sizeof(long)] = {};
+
+        explicit pod(long key = 0) : payload{key} {}
+        [[nodiscard]] long key() const { return payload[0]; }
+    };
+
+    /// 64 bytes owning a heap allocation: moves are not trivial, but relocating it with memcpy is safe
+    struct owner
+    {
+        long* value = nullptr;
+        long  pad[7] = {};
+
+        explicit owner(long key = 0) : value{new long(key)} {}
+        owner(owner&& other) noexcept : value{other.value} { other.value = nullptr; }
+        owner& operator=(owner&& other) noexcept
+        {
+            std::swap(value, other.value);
+            return *this;
+        }
+        ~owner() { delete value; }
+        [[nodiscard]] long key() const { return *value; }
+    };
+
+    constexpr int element_count = 1 << 20;
+    constexpr int churn_count   = 1 << 22;
+    constexpr int repeats       = 5;
+
+    double elapsed_ms(clock_type::time_point start)
+    {
+        const std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+        return elapsed.count();
+    }
+
+    template<typename T, typename Traits>
+    void run(const char* name)
+    {
+        using vector_type  = siv::vector<T, std::allocator<T>, Traits>;
+        using ordered_type = siv::vector<T, std::allocator<T>, siv::ordered_traits<Traits>>;
+
+        double grow_ms = 1e300, erase_ms = 1e300, sort_ms = 1e300, compact_ms = 1e300, churn_ms = 1e300;
+        for (int r = 0; r < repeats; ++r) {
+            vector_type vec;
+            std::vector<siv::id_type> ids(element_count);
+            auto start = clock_type::now();
+            for (int i = 0; i < element_count; ++i) {
+                ids[i] = vec.emplace_back(static_cast<long>(i) * 7919 % element_count);
+            }
+            grow_ms = std::min(grow_ms, elapsed_ms(start));
+
+            std::mt19937 rng(1);
+            std::shuffle(ids.begin(), ids.end(), rng);
+            start = clock_type::now();
+            for (int i = 0; i < element_count / 2; ++i) {
+                vec.erase(ids[i]);
+            }
+            erase_ms = std::min(erase_ms, elapsed_ms(start));
+
+            start = clock_type::now();
+            vec.sort([](const T& a, const T& b) { return a.key() < b.key(); });
+            sort_ms = std::min(sort_ms, elapsed_ms(start));
+
+            ordered_type ordered;
+            ordered.set_max_hole_ratio(1.0);
+            std::vector<siv::id_type> ordered_ids(element_count);
+            for (int i = 0; i < element_count; ++i) {
+                ordered_ids[i] = ordered.emplace_back(static_cast<long>(i));
+            }
+            for (int i = 0; i < element_count; i += 2) {
+                ordered.erase(ordered_ids[i]);
+            }
+            start = clock_type::now();
+            ordered.compact();
+            compact_ms = std::min(compact_ms, elapsed_ms(start));
+        }
+        for (int r = 0; r < repeats; ++r) {
+            vector_type vec;
+            std::vector<siv::id_type> ids(2048);
+            for (siv::id_type& id : ids) {
+                id = vec.emplace_back(1L);
+            }
+            std::mt19937 rng(3);
+            const auto start = clock_type::now();
+            for (int i = 0; i < churn_count; ++i) {
+                siv::id_type& id = ids[rng() % ids.size()];
+                vec.erase(id);
+                id = vec.emplace_back(static_cast<long>(i));
+            }
+            churn_ms = std::min(churn_ms, elapsed_ms(start));
+        }
+        std::printf("%-24s %8.1f %8.1f %8.1f %8.1f %8.1f\n", name, grow_ms, erase_ms, sort_ms, compact_ms, churn_ms);
+    }
+}
+
+template<>
+struct siv::is_trivially_relocatable<owner> : std::true_type {};
+
+int main()
+{
+    std::printf("%d elements, best of %d (ms)\n", element_count, repeats);
+    std::printf("%-24s %8s %8s %8s %8s %8s\n", "", "grow", "erase", "sort", "compact", "churn");
+    run<pod<64>, siv::default_traits>("64 B, std::vector");
+    run<pod<64>, siv::relocating_traits<>>("64 B, relocating");
+    run<pod<256>, siv::default_traits>("256 B, std::vector");
+    run<pod<256>, siv::relocating_traits<>>("256 B, relocating");
+    run<owner, siv::default_traits>("64 B owner, std::vector");
+    run<owner, siv::relocating_traits<>>("64 B owner, relocating");
+    return 0;
+}
@@ -1,14 +1,79 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <new>
+#include <numeric>
+#include <optional>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+    #define SIV_EXCEPTIONS 1
+#else
+    #define SIV_EXCEPTIONS 0
+#endif
+
+// Define SIV_NO_THREADS to run the siv::execution::par overloads on the calling thread only
+#ifndef SIV_NO_THREADS
+    #include <exception>
+    #include <mutex>
+    #include <thread>
+#endif
+
+// Minimum number of elements per thread of the siv::execution::par overloads (see benchmarks/parallel_bench.cpp)
+#ifndef SIV_PARALLEL_GRAIN
+    #define SIV_PARALLEL_GRAIN (std::size_t{1} << 17)
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+    #include <xmmintrin.h>
+#endif
+
+// Define SIV_NO_SIMD to keep bulk handle validation on the portable scalar loop
+#if !defined(SIV_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    #include <immintrin.h>
+    #define SIV_X86_SIMD 1
+#else
+    #define SIV_X86_SIMD 0
+#endif
+
+// Compiling as C++20 with coroutine support enables siv::experimental::for_each_interleaved()
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+    #if __has_include(<coroutine>)
+        #include <coroutine>
+        #include <exception>
+        #define SIV_COROUTINES 1
+    #endif
+#endif
+#ifndef SIV_COROUTINES
+    #define SIV_COROUTINES 0
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+    #define SIV_TSAN 1
+#elif defined(__has_feature)
+    #if __has_feature(thread_sanitizer)
+        #define SIV_TSAN 1
+    #endif
+#endif
+#ifndef SIV_TSAN
+    #define SIV_TSAN 0
+#endif
+
 namespace siv
 {
     /// Stable identifier type. Maps to an object through the index indirection layer.
@@ -16,493 +81,7401 @@ namespace siv
 
     inline constexpr id_type invalid_id = std::numeric_limits<id_type>::max();
 
-    template<typename T, typename Allocator = std::allocator<T>>
+    namespace detail
+    {
+        template<unsigned Bits>
+        using uint_least_t = std::conditional_t<(Bits <= 8),  uint8_t,
+                             std::conditional_t<(Bits <= 16), uint16_t,
+                             std::conditional_t<(Bits <= 32), uint32_t, uint64_t>>>;
+
+        /// Placeholder key type for traits whose ID and generation do not fit in 64 bits
+        struct no_key {};
+
+        template<unsigned Bits>
+        inline constexpr uint64_t low_mask = Bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << Bits) - 1;
+    }
+
+    /// How siv::vector fills the hole left by an erased element
+    enum class erase_policy
+    {
+        /// Move the last element into the hole: O(1), dense storage, data order changes
+        swap_and_pop,
+        /// Mark the slot dead in place: O(1), data order preserved, holes removed by compact()
+        tombstone
+    };
+
+    /// Which free ID an insertion recycles first
+    enum class recycle_policy
+    {
+        /// Most recently freed first: O(1), no extra memory, a hot slot keeps bumping one generation
+        lifo,
+        /// Least recently freed first: O(1), spreads generation bumps over every free ID
+        fifo,
+        /// Smallest free ID first: O(log n), keeps live IDs low so shrink_to_fit() can release the rest
+        lowest_id
+    };
+
+    /** Default observer of siv::vector: ignores every event, and compiles to nothing.
+     *  An observer keeps an external structure (spatial grid, GPU buffer, index into the data
+     *  array) in sync with the data positions. Derive from it and redeclare the events of interest;
+     *  select it with siv::observing_traits.
+     *
+     *  Callbacks run in the middle of the operation that triggers them: they receive everything
+     *  they need as arguments, must not access the vector and must not throw.
+     */
+    struct no_observer
+    {
+        /// The element with this ID was constructed at data index `index`
+        template<typename Id>
+        void on_insert(Id, std::size_t) noexcept {}
+
+        /// The element with this ID is about to be destroyed at data index `index`
+        template<typename Id>
+        void on_erase(Id, std::size_t) noexcept {}
+
+        /// The element with this ID moved from data index `from` to data index `to`
+        template<typename Id>
+        void on_relocate(Id, std::size_t, std::size_t) noexcept {}
+    };
+
+    /// Execution policy tags selecting the multi-threaded overloads of bulk operations
+    namespace execution
+    {
+        struct parallel_policy {};
+
+        /// Splits the work across the hardware threads once it is large enough to pay off
+        inline constexpr parallel_policy par{};
+    }
+
+    /** Bookkeeping policy for siv::vector and siv::handle.
+     *  Selects the width of stable IDs and generation counters. Narrow widths shrink the
+     *  per-element overhead (index entry + metadata) at the cost of a smaller ID space and
+     *  faster generation wrap-around. When IdBits + GenerationBits fit in 64 bits, IDs and
+     *  generations are packed together internally and a single-register key_type is provided.
+     *
+     *  The all-ones ID is reserved as the invalid ID. A slot whose generation can no longer be
+     *  bumped twice (once on reuse, once on erase) is retired instead of recycled, so a stale
+     *  handle can never alias a newer object.
+     *
+     *  Derive from an instantiation to override individual policies.
+     *
+     * @tparam IdBits Number of bits of an ID (8..64)
+     * @tparam GenerationBits Number of bits of a generation counter (2..64)
+     */
+    template<unsigned IdBits, unsigned GenerationBits>
+    struct basic_traits
+    {
+        static_assert(IdBits >= 8 && IdBits <= 64, "IdBits must be in [8, 64]");
+        static_assert(GenerationBits >= 2 && GenerationBits <= 64, "GenerationBits must be in [2, 64]");
+
+        static constexpr unsigned id_bits         = IdBits;
+        static constexpr unsigned generation_bits = GenerationBits;
+
+        using id_type         = detail::uint_least_t<IdBits>;
+        using generation_type = detail::uint_least_t<GenerationBits>;
+        using key_type        = std::conditional_t<(IdBits + GenerationBits <= 64),
+                                                   detail::uint_least_t<IdBits + GenerationBits>,
+                                                   detail::no_key>;
+
+        /// Store each generation next to its data index in the ID table instead of in the metadata.
+        /// Handle validation then reads one index entry, and a checked dereference two cache lines.
+        static constexpr bool colocated_generation = false;
+
+        /// How erase() fills holes (see siv::erase_policy)
+        static constexpr erase_policy erase_mode = erase_policy::swap_and_pop;
+
+        /// Which free ID is reused next (see siv::recycle_policy)
+        static constexpr recycle_policy recycle_mode = recycle_policy::lifo;
+
+        /// Number of free IDs held back from reuse: fresh IDs are created until more are free.
+        /// Delays the reuse of an ID, so narrow generations wrap more slowly.
+        static constexpr std::size_t quarantine = 0;
+
+        /// With erase_policy::tombstone, compact() runs automatically once holes exceed this
+        /// share of the slots. 1.0 or more disables automatic compaction.
+        static constexpr double max_hole_ratio = 0.5;
+
+        /// Receives insertions, erasures and relocations of elements (see siv::observing_traits)
+        using observer = no_observer;
+
+        /// Sequence storing the elements of siv::vector. Any std::vector-like container works;
+        /// siv::paged_traits selects siv::paged_storage for pointer stability across growth.
+        template<typename U, typename Alloc>
+        using storage = std::vector<U, Alloc>;
+
+        /// Sequence storing the metadata and index tables (see siv::static_traits, siv::small_traits)
+        template<typename U, typename Alloc>
+        using table_storage = std::vector<U, Alloc>;
+    };
+
+    /// 64-bit IDs and generations: the historical layout, never retires slots in practice
+    using default_traits = basic_traits<64, 64>;
+
+    /// 32-bit IDs and generations: 12 bytes of bookkeeping per element, 64-bit packed keys
+    using compact_traits = basic_traits<32, 32>;
+
+    template<typename T, typename Allocator = std::allocator<T>, typename Traits = default_traits>
     class vector;
 
-    /** A standalone smart reference to an object managed by a siv::vector.
-     *  Tracks validity via a generation counter to detect use-after-erase.
+    template<typename T, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class handle_set;
+
+    template<typename T, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class id_reservation;
+
+    template<typename T, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class command_buffer;
+
+    template<typename T, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class command_queue;
+
+    template<typename T, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class optimistic_vector;
+
+    template<typename T, std::size_t MaxReaders = 64, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class epoch_vector;
+
+    template<typename Allocator, typename Traits, typename... Ts>
+    class basic_soa_vector;
+
+    template<typename Allocator, typename Traits, typename... Ts>
+    class basic_soa_handle;
+
+    /// siv::basic_soa_vector with the default allocator and traits
+    template<typename... Ts>
+    using soa_vector = basic_soa_vector<std::allocator<std::byte>, default_traits, Ts...>;
+
+    /// Handle to a row of a siv::soa_vector
+    template<typename... Ts>
+    using soa_handle = basic_soa_handle<std::allocator<std::byte>, default_traits, Ts...>;
+
+    /** A non-owning view over a contiguous sequence (minimal C++17 stand-in for std::span).
      *
-     * @tparam T The type of the referenced object
-     * @tparam Allocator The allocator type used by the owning vector
+     * @tparam T The element type, possibly const-qualified
      */
-    template<typename T, typename Allocator = std::allocator<T>>
-    class handle
+    template<typename T>
+    class span
     {
     public:
-        handle() = default;
+        using element_type = T;
+        using value_type   = std::remove_cv_t<T>;
+        using size_type    = std::size_t;
+        using pointer      = T*;
+        using reference    = T&;
+        using iterator     = T*;
 
-        T* operator->()
+        constexpr span() noexcept = default;
+
+        constexpr span(T* data, size_type size) noexcept
+            : m_data{data}
+            , m_size{size}
+        {}
+
+        /// Allows span<const T> to be built from span<T>
+        template<typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+        constexpr span(const span<U>& other) noexcept
+            : m_data{other.data()}
+            , m_size{other.size()}
+        {}
+
+        /// Views a contiguous container such as std::vector or std::array
+        template<typename Container,
+                 typename = std::enable_if_t<!std::is_same_v<std::remove_cv_t<Container>, span>
+                                          && std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>>
+        constexpr span(Container& c) noexcept
+            : m_data{c.data()}
+            , m_size{c.size()}
+        {}
+
+        constexpr reference operator[](size_type idx) const
         {
-            assert(valid() && "Dereferencing invalid handle");
-            return &(*m_vector)[m_id];
+            assert(idx < m_size && "span index out of range");
+            return m_data[idx];
         }
 
-        const T* operator->() const
+        [[nodiscard]] constexpr pointer   data()  const noexcept { return m_data;           }
+        [[nodiscard]] constexpr size_type size()  const noexcept { return m_size;           }
+        [[nodiscard]] constexpr bool      empty() const noexcept { return m_size == 0;      }
+        constexpr iterator                begin() const noexcept { return m_data;           }
+        constexpr iterator                end()   const noexcept { return m_data + m_size;  }
+
+    private:
+        T*        m_data = nullptr;
+        size_type m_size = 0;
+    };
+
+    /** Element storage made of fixed-size pages that are never moved once allocated.
+     *  Growth only appends pages, so pointers and references to elements stay valid until the
+     *  element itself is erased (or relocated into an erased hole). Elements are contiguous within
+     *  a page; use page_count()/page(i) to run tight loops over each contiguous run.
+     *  Exposes the subset of the std::vector interface used by siv::vector.
+     *
+     * @tparam T The element type
+     * @tparam PageSize Number of elements per page, a power of two
+     * @tparam Allocator The allocator used for pages (and, rebound, for the page table)
+     */
+    template<typename T, std::size_t PageSize, typename Allocator = std::allocator<T>>
+    class paged_storage
+    {
+        static_assert(PageSize > 0 && (PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+
+        using alloc_traits         = std::allocator_traits<Allocator>;
+        using page_table_allocator = typename alloc_traits::template rebind_alloc<T*>;
+
+        static constexpr std::size_t page_mask = PageSize - 1;
+
+        template<bool Const>
+        class basic_iterator
         {
-            assert(valid() && "Dereferencing invalid handle");
-            return &(*m_vector)[m_id];
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = std::conditional_t<Const, const T*, T*>;
+            using reference         = std::conditional_t<Const, const T&, T&>;
+
+            basic_iterator() = default;
+
+            basic_iterator(T* const* pages, std::size_t pos)
+                : m_pages{pages}
+                , m_pos{pos}
+            {}
+
+            /// Allows iterator -> const_iterator conversion
+            template<bool C = Const, typename = std::enable_if_t<C>>
+            basic_iterator(const basic_iterator<false>& other)
+                : m_pages{other.m_pages}
+                , m_pos{other.m_pos}
+            {}
+
+            reference operator*()  const { return m_pages[m_pos / PageSize][m_pos & page_mask]; }
+            pointer   operator->() const { return &**this; }
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            basic_iterator& operator++()    { ++m_pos; return *this; }
+            basic_iterator& operator--()    { --m_pos; return *this; }
+            basic_iterator  operator++(int) { auto it = *this; ++m_pos; return it; }
+            basic_iterator  operator--(int) { auto it = *this; --m_pos; return it; }
+
+            basic_iterator& operator+=(difference_type n) { m_pos += n; return *this; }
+            basic_iterator& operator-=(difference_type n) { m_pos -= n; return *this; }
+
+            friend basic_iterator  operator+(basic_iterator it, difference_type n) { return it += n; }
+            friend basic_iterator  operator+(difference_type n, basic_iterator it) { return it += n; }
+            friend basic_iterator  operator-(basic_iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const basic_iterator& a, const basic_iterator& b)
+            {
+                return static_cast<difference_type>(a.m_pos) - static_cast<difference_type>(b.m_pos);
+            }
+
+            friend bool operator==(const basic_iterator& a, const basic_iterator& b) { return a.m_pos == b.m_pos; }
+            friend bool operator!=(const basic_iterator& a, const basic_iterator& b) { return a.m_pos != b.m_pos; }
+            friend bool operator< (const basic_iterator& a, const basic_iterator& b) { return a.m_pos <  b.m_pos; }
+            friend bool operator> (const basic_iterator& a, const basic_iterator& b) { return a.m_pos >  b.m_pos; }
+            friend bool operator<=(const basic_iterator& a, const basic_iterator& b) { return a.m_pos <= b.m_pos; }
+            friend bool operator>=(const basic_iterator& a, const basic_iterator& b) { return a.m_pos >= b.m_pos; }
+
+        private:
+            T* const*   m_pages = nullptr;
+            std::size_t m_pos   = 0;
+
+            friend class basic_iterator<!Const>;
+        };
+
+    public:
+        using value_type             = T;
+        using allocator_type         = Allocator;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using reference              = T&;
+        using const_reference        = const T&;
+        using iterator               = basic_iterator<false>;
+        using const_iterator         = basic_iterator<true>;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        static constexpr size_type page_size = PageSize;
+
+        paged_storage() = default;
+
+        explicit paged_storage(const Allocator& alloc)
+            : m_alloc(alloc)
+            , m_pages(page_table_allocator(alloc))
+        {}
+
+        paged_storage(const paged_storage&) = delete;
+        paged_storage& operator=(const paged_storage&) = delete;
+
+        ~paged_storage()
+        {
+            clear();
+            for (T* p : m_pages) {
+                alloc_traits::deallocate(m_alloc, p, PageSize);
+            }
         }
 
-        T& operator*()
+        // -- Element access --
+
+        reference       operator[](size_type idx)       { return m_pages[idx / PageSize][idx & page_mask]; }
+        const_reference operator[](size_type idx) const { return m_pages[idx / PageSize][idx & page_mask]; }
+
+        reference       front()       { return (*this)[0];          }
+        const_reference front() const { return (*this)[0];          }
+        reference       back()        { return (*this)[m_size - 1]; }
+        const_reference back()  const { return (*this)[m_size - 1]; }
+
+        /// Number of pages holding at least one element
+        [[nodiscard]]
+        size_type page_count() const noexcept
         {
-            assert(valid() && "Dereferencing invalid handle");
-            return (*m_vector)[m_id];
+            return (m_size + page_mask) / PageSize;
         }
 
-        const T& operator*() const
+        /// Contiguous view of the elements stored in page `i`
+        [[nodiscard]]
+        span<T> page(size_type i) noexcept
         {
-            assert(valid() && "Dereferencing invalid handle");
-            return (*m_vector)[m_id];
+            assert(i < page_count() && "Page index out of range");
+            return {m_pages[i], std::min(PageSize, m_size - i * PageSize)};
         }
 
         [[nodiscard]]
-        id_type id() const noexcept
+        span<const T> page(size_type i) const noexcept
         {
-            return m_id;
+            assert(i < page_count() && "Page index out of range");
+            return {m_pages[i], std::min(PageSize, m_size - i * PageSize)};
         }
 
+        // -- Iterators --
+
+        iterator       begin()        noexcept { return {m_pages.data(), 0};      }
+        iterator       end()          noexcept { return {m_pages.data(), m_size}; }
+        const_iterator begin()  const noexcept { return {m_pages.data(), 0};      }
+        const_iterator end()    const noexcept { return {m_pages.data(), m_size}; }
+        const_iterator cbegin() const noexcept { return begin();                  }
+        const_iterator cend()   const noexcept { return end();                    }
+
+        reverse_iterator       rbegin()        noexcept { return reverse_iterator(end());         }
+        reverse_iterator       rend()          noexcept { return reverse_iterator(begin());       }
+        const_reverse_iterator rbegin()  const noexcept { return const_reverse_iterator(end());   }
+        const_reverse_iterator rend()    const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin();                        }
+        const_reverse_iterator crend()   const noexcept { return rend();                          }
+
+        // -- Capacity --
+
+        [[nodiscard]] bool      empty()    const noexcept { return m_size == 0;                  }
+        [[nodiscard]] size_type size()     const noexcept { return m_size;                       }
+        [[nodiscard]] size_type capacity() const noexcept { return m_pages.size() * PageSize;    }
+
         [[nodiscard]]
-        id_type generation() const noexcept
+        size_type max_size() const noexcept
         {
-            return m_generation;
+            return std::min(alloc_traits::max_size(m_alloc) / PageSize, m_pages.max_size()) * PageSize;
         }
 
-        explicit operator bool() const noexcept
+        /// Allocates pages until `new_cap` elements fit. Existing elements never move.
+        void reserve(size_type new_cap)
         {
-            return valid();
+            const size_type needed = (new_cap + page_mask) / PageSize;
+            if (needed > m_pages.size()) {
+                m_pages.reserve(needed);
+                while (m_pages.size() < needed) {
+                    m_pages.push_back(alloc_traits::allocate(m_alloc, PageSize));
+                }
+            }
+        }
+
+        /// Releases the pages past the last element
+        void shrink_to_fit()
+        {
+            const size_type used = page_count();
+            for (size_type i = used; i < m_pages.size(); ++i) {
+                alloc_traits::deallocate(m_alloc, m_pages[i], PageSize);
+            }
+            m_pages.resize(used);
+            m_pages.shrink_to_fit();
         }
 
         [[nodiscard]]
-        bool valid() const noexcept
+        allocator_type get_allocator() const noexcept
         {
-            return m_vector && m_vector->is_valid(m_id, m_generation);
+            return m_alloc;
         }
 
-    private:
-        handle(id_type id, id_type generation, vector<T, Allocator>* vec)
-            : m_id{id}
-            , m_generation{generation}
-            , m_vector{vec}
-        {}
+        // -- Modifiers --
+
+        /// Destroys every element; pages are kept for reuse
+        void clear() noexcept
+        {
+            while (m_size > 0) {
+                pop_back();
+            }
+        }
+
+        void push_back(const T& value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            if (m_size == capacity()) {
+                // Grow the page table first so a failure leaves no unreferenced page behind
+                if (m_pages.size() == m_pages.capacity()) {
+                    m_pages.reserve(std::max<size_type>(m_pages.capacity() * 2, 8));
+                }
+                m_pages.push_back(alloc_traits::allocate(m_alloc, PageSize));
+            }
+            T* slot = m_pages[m_size / PageSize] + (m_size & page_mask);
+            alloc_traits::construct(m_alloc, slot, std::forward<Args>(args)...);
+            ++m_size;
+            return *slot;
+        }
 
-        id_type                m_id         = 0;
-        id_type                m_generation = 0;
-        vector<T, Allocator>*  m_vector     = nullptr;
+        void pop_back() noexcept
+        {
+            assert(m_size > 0 && "pop_back on empty storage");
+            --m_size;
+            alloc_traits::destroy(m_alloc, m_pages[m_size / PageSize] + (m_size & page_mask));
+        }
 
-        friend class vector<T, Allocator>;
+    private:
+        Allocator                              m_alloc;
+        std::vector<T*, page_table_allocator>  m_pages;
+        size_type                              m_size = 0;
     };
 
-    /** A vector providing stable IDs for element access.
-     *  IDs remain valid across insertions and deletions of other elements.
-     *  Data is stored contiguously for cache-friendly iteration.
+    /** Traits selecting siv::paged_storage for the elements of siv::vector.
      *
-     * @tparam T The element type. Must be move-constructible and move-assignable.
-     * @tparam Allocator The allocator type. Defaults to std::allocator<T>.
+     * @tparam PageSize Number of elements per page, a power of two
+     * @tparam Base The traits to extend
      */
-    template<typename T, typename Allocator>
-    class vector
+    template<std::size_t PageSize, typename Base = default_traits>
+    struct paged_traits : Base
     {
-        struct metadata
-        {
-            id_type rid        = 0;
-            id_type generation = 0;
-        };
+        template<typename U, typename Alloc>
+        using storage = paged_storage<U, PageSize, Alloc>;
+    };
+
+    /** Element storage whose first N elements live inside the object itself.
+     *  With Spill, growing past N moves the elements to the heap (small-buffer optimization);
+     *  without it, N is a hard capacity and exceeding it throws std::length_error (or asserts
+     *  with -fno-exceptions). The object stores a pointer into itself, so it is neither copyable
+     *  nor movable. Exposes the subset of the std::vector interface used by siv::vector.
+     *
+     * @tparam T The element type
+     * @tparam N Number of elements stored inline
+     * @tparam Allocator The allocator used once spilled to the heap
+     * @tparam Spill Whether the storage may grow past N
+     */
+    template<typename T, std::size_t N, typename Allocator, bool Spill>
+    class basic_inline_storage
+    {
+        static_assert(N > 0, "Inline capacity must be at least 1");
 
-        using metadata_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<metadata>;
-        using index_allocator_type    = typename std::allocator_traits<Allocator>::template rebind_alloc<id_type>;
+        using alloc_traits = std::allocator_traits<Allocator>;
 
     public:
-        // -- Member types (std::vector compatible) --
-
         using value_type             = T;
         using allocator_type         = Allocator;
         using size_type              = std::size_t;
         using difference_type        = std::ptrdiff_t;
         using reference              = T&;
         using const_reference        = const T&;
-        using pointer                = T*;
-        using const_pointer          = const T*;
-        using iterator               = typename std::vector<T, Allocator>::iterator;
-        using const_iterator         = typename std::vector<T, Allocator>::const_iterator;
-        using reverse_iterator       = typename std::vector<T, Allocator>::reverse_iterator;
-        using const_reverse_iterator = typename std::vector<T, Allocator>::const_reverse_iterator;
+        using iterator               = T*;
+        using const_iterator         = const T*;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-        // -- Constructors / assignment --
+        static constexpr size_type inline_capacity = N;
 
-        vector() = default;
+        basic_inline_storage() = default;
 
-        explicit vector(const Allocator& alloc)
-            : m_data(alloc)
-            , m_metadata(metadata_allocator_type(alloc))
-            , m_indexes(index_allocator_type(alloc))
+        explicit basic_inline_storage(const Allocator& alloc)
+            : m_alloc(alloc)
         {}
 
-        /// Non-copyable and non-movable to prevent dangling handle pointers
-        vector(const vector&) = delete;
-        vector& operator=(const vector&) = delete;
-        vector(vector&&) = delete;
-        vector& operator=(vector&&) = delete;
+        basic_inline_storage(const basic_inline_storage&) = delete;
+        basic_inline_storage& operator=(const basic_inline_storage&) = delete;
+
+        ~basic_inline_storage()
+        {
+            clear();
+            release_heap();
+        }
 
         // -- Element access --
 
-        /** Bounds-checked access by ID.
-         *  @throws std::out_of_range if exceptions are enabled, otherwise asserts
+        reference       operator[](size_type idx)       { return m_ptr[idx];          }
+        const_reference operator[](size_type idx) const { return m_ptr[idx];          }
+        reference       front()                         { return m_ptr[0];            }
+        const_reference front() const                   { return m_ptr[0];            }
+        reference       back()                          { return m_ptr[m_size - 1];   }
+        const_reference back()  const                   { return m_ptr[m_size - 1];   }
+        T*              data()        noexcept          { return m_ptr;               }
+        const T*        data()  const noexcept          { return m_ptr;               }
+
+        /// Whether the elements currently live in the inline buffer
+        [[nodiscard]]
+        bool is_inline() const noexcept
+        {
+            return m_ptr == inline_data();
+        }
+
+        // -- Iterators --
+
+        iterator       begin()        noexcept { return m_ptr;          }
+        iterator       end()          noexcept { return m_ptr + m_size; }
+        const_iterator begin()  const noexcept { return m_ptr;          }
+        const_iterator end()    const noexcept { return m_ptr + m_size; }
+        const_iterator cbegin() const noexcept { return begin();        }
+        const_iterator cend()   const noexcept { return end();          }
+
+        reverse_iterator       rbegin()        noexcept { return reverse_iterator(end());         }
+        reverse_iterator       rend()          noexcept { return reverse_iterator(begin());       }
+        const_reverse_iterator rbegin()  const noexcept { return const_reverse_iterator(end());   }
+        const_reverse_iterator rend()    const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin();                        }
+        const_reverse_iterator crend()   const noexcept { return rend();                          }
+
+        // -- Capacity --
+
+        [[nodiscard]] bool      empty()    const noexcept { return m_size == 0; }
+        [[nodiscard]] size_type size()     const noexcept { return m_size;      }
+        [[nodiscard]] size_type capacity() const noexcept { return m_capacity;  }
+
+        [[nodiscard]]
+        size_type max_size() const noexcept
+        {
+            if constexpr (Spill) {
+                return alloc_traits::max_size(m_alloc);
+            } else {
+                return N;
+            }
+        }
+
+        void reserve(size_type new_cap)
+        {
+            if (new_cap > m_capacity) {
+                reallocate(new_cap);
+            }
+        }
+
+        /// Moves the elements back inline when they fit, or trims the heap buffer otherwise
+        void shrink_to_fit()
+        {
+            if (!is_inline() && m_size < m_capacity) {
+                reallocate(m_size);
+            }
+        }
+
+        [[nodiscard]]
+        allocator_type get_allocator() const noexcept
+        {
+            return m_alloc;
+        }
+
+        // -- Modifiers --
+
+        void clear() noexcept
+        {
+            std::destroy(m_ptr, m_ptr + m_size);
+            m_size = 0;
+        }
+
+        void push_back(const T& value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            if (m_size == m_capacity) {
+                reallocate(std::max(m_capacity * 2, m_size + 1));
+            }
+            T* slot = m_ptr + m_size;
+            ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+            ++m_size;
+            return *slot;
+        }
+
+        void pop_back() noexcept
+        {
+            assert(m_size > 0 && "pop_back on empty storage");
+            --m_size;
+            std::destroy_at(m_ptr + m_size);
+        }
+
+    private:
+        [[nodiscard]] T*       inline_data()       noexcept { return reinterpret_cast<T*>(m_inline);       }
+        [[nodiscard]] const T* inline_data() const noexcept { return reinterpret_cast<const T*>(m_inline); }
+
+        /// Moves the elements to a buffer of `new_cap` elements (the inline one if it fits)
+        void reallocate(size_type new_cap)
+        {
+            if constexpr (!Spill) {
+                if (new_cap > N) {
+#if SIV_EXCEPTIONS
+                    throw std::length_error("siv: fixed capacity exceeded");
+#else
+                    assert(false && "siv: fixed capacity exceeded");
+#endif
+                }
+            } else {
+                const bool to_inline = new_cap <= N;
+                if (to_inline && is_inline()) {
+                    return;
+                }
+                T* target = to_inline ? inline_data() : alloc_traits::allocate(m_alloc, new_cap);
+#if SIV_EXCEPTIONS
+                try {
+                    std::uninitialized_move(m_ptr, m_ptr + m_size, target);
+                } catch (...) {
+                    if (!to_inline) {
+                        alloc_traits::deallocate(m_alloc, target, new_cap);
+                    }
+                    throw;
+                }
+#else
+                std::uninitialized_move(m_ptr, m_ptr + m_size, target);
+#endif
+                std::destroy(m_ptr, m_ptr + m_size);
+                release_heap();
+                m_ptr      = target;
+                m_capacity = to_inline ? N : new_cap;
+            }
+        }
+
+        void release_heap() noexcept
+        {
+            if (!is_inline()) {
+                alloc_traits::deallocate(m_alloc, m_ptr, m_capacity);
+            }
+        }
+
+        alignas(T) unsigned char  m_inline[N * sizeof(T)];
+        T*                        m_ptr      = inline_data();
+        size_type                 m_size     = 0;
+        size_type                 m_capacity = N;
+        Allocator                 m_alloc;
+    };
+
+    /// Fixed-capacity storage: all N elements live inside the owning object, never on the heap
+    template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+    using static_storage = basic_inline_storage<T, N, Allocator, false>;
+
+    /// Small-buffer storage: inline up to N elements, spills to the heap beyond
+    template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+    using small_storage = basic_inline_storage<T, N, Allocator, true>;
+
+    /** Traits keeping the elements, the metadata and the index table of siv::vector inline.
+     *  Capacity is fixed to N live elements; no heap allocation ever happens.
+     *
+     * @tparam N Maximum number of elements (and IDs)
+     * @tparam Base The traits to extend
+     */
+    template<std::size_t N, typename Base = default_traits>
+    struct static_traits : Base
+    {
+        template<typename U, typename Alloc>
+        using storage = static_storage<U, N, Alloc>;
+
+        template<typename U, typename Alloc>
+        using table_storage = static_storage<U, N, Alloc>;
+    };
+
+    /** Traits keeping the three arrays of siv::vector inline up to N entries, spilling to the
+     *  heap beyond that.
+     *
+     * @tparam N Number of elements (and IDs) stored inline
+     * @tparam Base The traits to extend
+     */
+    template<std::size_t N, typename Base = default_traits>
+    struct small_traits : Base
+    {
+        template<typename U, typename Alloc>
+        using storage = small_storage<U, N, Alloc>;
+
+        template<typename U, typename Alloc>
+        using table_storage = small_storage<U, N, Alloc>;
+    };
+
+    /** Whether T may be relocated (moved to a new address, the source being abandoned without its
+     *  destructor running) with a plain memcpy. True for trivially copyable types; specialize it
+     *  for types that only hold pointers to other objects, such as std::unique_ptr-like owners.
+     *  A type pointing into itself (e.g. an inline-buffer string) must not be marked.
+     */
+    template<typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+    template<typename T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    /** Heap element storage relocating trivially relocatable elements with memcpy instead of
+     *  constructing, moving and destroying them. Growth is a single std::realloc() with
+     *  std::allocator (which may extend the block in place), or an allocate + memcpy otherwise.
+     *  swap_and_pop() and compact() let siv::vector erase and compact with one memcpy per moved
+     *  element. Elements that are not trivially relocatable fall back to moves, as std::vector does.
+     *  Exposes the subset of the std::vector interface used by siv::vector.
+     *
+     * @tparam T The element type
+     * @tparam Allocator The allocator type
+     */
+    template<typename T, typename Allocator = std::allocator<T>>
+    class relocating_storage
+    {
+        using alloc_traits = std::allocator_traits<Allocator>;
+
+    public:
+        using value_type             = T;
+        using allocator_type         = Allocator;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using reference              = T&;
+        using const_reference        = const T&;
+        using iterator               = T*;
+        using const_iterator         = const T*;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        /// Whether elements are relocated with memcpy
+        static constexpr bool trivially_relocatable = is_trivially_relocatable_v<T>;
+
+        relocating_storage() = default;
+
+        explicit relocating_storage(const Allocator& alloc)
+            : m_alloc(alloc)
+        {}
+
+        relocating_storage(const relocating_storage&) = delete;
+        relocating_storage& operator=(const relocating_storage&) = delete;
+
+        ~relocating_storage()
+        {
+            clear();
+            release(m_ptr, m_capacity);
+        }
+
+        // -- Element access --
+
+        reference       operator[](size_type idx)       { return m_ptr[idx];        }
+        const_reference operator[](size_type idx) const { return m_ptr[idx];        }
+        reference       front()                         { return m_ptr[0];          }
+        const_reference front() const                   { return m_ptr[0];          }
+        reference       back()                          { return m_ptr[m_size - 1]; }
+        const_reference back()  const                   { return m_ptr[m_size - 1]; }
+        T*              data()        noexcept          { return m_ptr;             }
+        const T*        data()  const noexcept          { return m_ptr;             }
+
+        // -- Iterators --
+
+        iterator       begin()        noexcept { return m_ptr;          }
+        iterator       end()          noexcept { return m_ptr + m_size; }
+        const_iterator begin()  const noexcept { return m_ptr;          }
+        const_iterator end()    const noexcept { return m_ptr + m_size; }
+        const_iterator cbegin() const noexcept { return begin();        }
+        const_iterator cend()   const noexcept { return end();          }
+
+        reverse_iterator       rbegin()        noexcept { return reverse_iterator(end());         }
+        reverse_iterator       rend()          noexcept { return reverse_iterator(begin());       }
+        const_reverse_iterator rbegin()  const noexcept { return const_reverse_iterator(end());   }
+        const_reverse_iterator rend()    const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin();                        }
+        const_reverse_iterator crend()   const noexcept { return rend();                          }
+
+        // -- Capacity --
+
+        [[nodiscard]] bool      empty()    const noexcept { return m_size == 0; }
+        [[nodiscard]] size_type size()     const noexcept { return m_size;      }
+        [[nodiscard]] size_type capacity() const noexcept { return m_capacity;  }
+
+        [[nodiscard]]
+        size_type max_size() const noexcept
+        {
+            return alloc_traits::max_size(m_alloc);
+        }
+
+        void reserve(size_type new_cap)
+        {
+            if (new_cap > m_capacity) {
+                reallocate(new_cap);
+            }
+        }
+
+        void shrink_to_fit()
+        {
+            if (m_size < m_capacity) {
+                reallocate(m_size);
+            }
+        }
+
+        [[nodiscard]]
+        allocator_type get_allocator() const noexcept
+        {
+            return m_alloc;
+        }
+
+        // -- Modifiers --
+
+        void clear() noexcept
+        {
+            destroy(0, m_size);
+            m_size = 0;
+        }
+
+        void push_back(const T& value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            if (m_size == m_capacity) {
+                reallocate(std::max<size_type>(m_capacity * 2, 16));
+            }
+            alloc_traits::construct(m_alloc, m_ptr + m_size, std::forward<Args>(args)...);
+            return m_ptr[m_size++];
+        }
+
+        void pop_back() noexcept
+        {
+            assert(m_size > 0 && "pop_back on empty storage");
+            --m_size;
+            alloc_traits::destroy(m_alloc, m_ptr + m_size);
+        }
+
+        /// Grows with value-initialized elements (through the allocator), or destroys the last ones.
+        /// Growth is all or nothing.
+        void resize(size_type n)
+        {
+            reserve(n);
+            [[maybe_unused]] const size_type old_size = m_size;
+#if SIV_EXCEPTIONS
+            try {
+#endif
+                while (m_size < n) {
+                    alloc_traits::construct(m_alloc, m_ptr + m_size);
+                    ++m_size;
+                }
+#if SIV_EXCEPTIONS
+            } catch (...) {
+                while (m_size > old_size) {
+                    pop_back();
+                }
+                throw;
+            }
+#endif
+            while (m_size > n) {
+                pop_back();
+            }
+        }
+
+        // -- Relocation (trivially relocatable elements only) --
+
+        /// Destroys the element at `pos`, then relocates the last element into its slot
+        void swap_and_pop(size_type pos) noexcept
+        {
+            assert(pos < m_size && "Index out of range");
+            --m_size;
+            alloc_traits::destroy(m_alloc, m_ptr + pos);
+            if (pos != m_size) {
+                relocate(m_ptr + m_size, m_ptr + pos, 1);
+            }
+        }
+
+        /** Destroys every element for which is_dead(pos) holds and relocates the others to the
+         *  front, keeping their order. Calls moved(from, to) before each relocation.
+         *  @return The new size
+         */
+        template<typename IsDead, typename Moved>
+        size_type compact(IsDead&& is_dead, Moved&& moved) noexcept
+        {
+            size_type write = 0;
+            for (size_type pos{0}; pos < m_size; ++pos) {
+                if (is_dead(pos)) {
+                    alloc_traits::destroy(m_alloc, m_ptr + pos);
+                } else {
+                    if (write != pos) {
+                        moved(pos, write);
+                        relocate(m_ptr + pos, m_ptr + write, 1);
+                    }
+                    ++write;
+                }
+            }
+            m_size = write;
+            return write;
+        }
+
+    private:
+        static constexpr bool uses_realloc = trivially_relocatable
+                                          && std::is_same_v<Allocator, std::allocator<T>>
+                                          && alignof(T) <= alignof(std::max_align_t);
+
+        /// Relocates `n` elements from `src` to the uninitialized `dst`, leaving `src` uninitialized
+        static void relocate(T* src, T* dst, size_type n) noexcept
+        {
+            static_assert(trivially_relocatable, "Only trivially relocatable elements are relocated with memcpy");
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+            }
+        }
+
+        void destroy(size_type first, size_type last) noexcept
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (size_type i = first; i < last; ++i) {
+                    alloc_traits::destroy(m_alloc, m_ptr + i);
+                }
+            } else {
+                (void)first;
+                (void)last;
+            }
+        }
+
+        /// Moves the elements to a buffer of `new_cap` elements
+        void reallocate(size_type new_cap)
+        {
+            if (new_cap > max_size()) {
+#if SIV_EXCEPTIONS
+                throw std::length_error("siv: relocating_storage too large");
+#else
+                assert(false && "siv: relocating_storage too large");
+#endif
+            }
+            T* target = nullptr;
+            if constexpr (uses_realloc) {
+                if (new_cap == 0) {
+                    release(m_ptr, m_capacity);
+                } else {
+                    target = static_cast<T*>(std::realloc(static_cast<void*>(m_ptr), new_cap * sizeof(T)));
+                    if (target == nullptr) {
+#if SIV_EXCEPTIONS
+                        throw std::bad_alloc();
+#else
+                        assert(false && "siv: out of memory");
+#endif
+                    }
+                }
+            } else {
+                if (new_cap > 0) {
+                    target = alloc_traits::allocate(m_alloc, new_cap);
+                    if constexpr (trivially_relocatable) {
+                        relocate(m_ptr, target, m_size);
+                    } else {
+#if SIV_EXCEPTIONS
+                        try {
+                            std::uninitialized_move(m_ptr, m_ptr + m_size, target);
+                        } catch (...) {
+                            alloc_traits::deallocate(m_alloc, target, new_cap);
+                            throw;
+                        }
+#else
+                        std::uninitialized_move(m_ptr, m_ptr + m_size, target);
+#endif
+                        destroy(0, m_size);
+                    }
+                }
+                release(m_ptr, m_capacity);
+            }
+            m_ptr      = target;
+            m_capacity = new_cap;
+        }
+
+        void release(T* ptr, size_type capacity) noexcept
+        {
+            if (ptr == nullptr) {
+                return;
+            }
+            if constexpr (uses_realloc) {
+                std::free(static_cast<void*>(ptr));
+            } else {
+                alloc_traits::deallocate(m_alloc, ptr, capacity);
+            }
+        }
+
+        T*        m_ptr      = nullptr;
+        size_type m_size     = 0;
+        size_type m_capacity = 0;
+        Allocator m_alloc;
+    };
+
+    /** Traits selecting siv::relocating_storage for the elements of siv::vector: erase(),
+     *  compact(), sort() and growth relocate trivially relocatable elements with memcpy.
+     *
+     * @tparam Base The traits to extend
+     */
+    template<typename Base = default_traits>
+    struct relocating_traits : Base
+    {
+        template<typename U, typename Alloc>
+        using storage = relocating_storage<U, Alloc>;
+    };
+
+    /** Traits selecting erase_policy::tombstone: erasing keeps the data order intact.
+     *
+     * @tparam Base The traits to extend
+     */
+    template<typename Base = default_traits>
+    struct ordered_traits : Base
+    {
+        static constexpr erase_policy erase_mode = erase_policy::tombstone;
+    };
+
+    /** Traits selecting how free IDs are recycled.
+     *
+     * @tparam Mode The order in which free IDs are reused
+     * @tparam Quarantine The number of free IDs held back from reuse
+     * @tparam Base The traits to extend
+     */
+    template<recycle_policy Mode, std::size_t Quarantine = 0, typename Base = default_traits>
+    struct recycling_traits : Base
+    {
+        static constexpr recycle_policy recycle_mode = Mode;
+        static constexpr std::size_t    quarantine   = Quarantine;
+    };
+
+    /** Traits attaching an observer to siv::vector (see siv::no_observer). The vector owns one
+     *  Observer instance, reachable through observer().
+     *
+     * @tparam Observer The observer type, usually derived from siv::no_observer
+     * @tparam Base The traits to extend
+     */
+    template<typename Observer, typename Base = default_traits>
+    struct observing_traits : Base
+    {
+        using observer = Observer;
+    };
+
+    /// A siv::vector holding at most N elements, with all storage inside the object
+    template<typename T, std::size_t N>
+    using static_vector = vector<T, std::allocator<T>, static_traits<N>>;
+
+    /// A siv::vector storing up to N elements inline before spilling to the heap
+    template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+    using small_vector = vector<T, Allocator, small_traits<N>>;
+
+    /** Allocator adaptor whose argument-less construct() default-initializes instead of
+     *  value-initializing. Growing a siv::vector of trivial elements with resize() or emplace_n()
+     *  then leaves them uninitialized rather than zeroing them.
+     *
+     * @tparam T The allocated type
+     * @tparam Base The adapted allocator
+     */
+    template<typename T, typename Base = std::allocator<T>>
+    class default_init_allocator : public Base
+    {
+        using base_traits = std::allocator_traits<Base>;
+
+    public:
+        template<typename U>
+        struct rebind
+        {
+            using other = default_init_allocator<U, typename base_traits::template rebind_alloc<U>>;
+        };
+
+        using Base::Base;
+
+        default_init_allocator() = default;
+
+        template<typename U, typename OtherBase>
+        default_init_allocator(const default_init_allocator<U, OtherBase>& other) noexcept
+            : Base(static_cast<const OtherBase&>(other))
+        {}
+
+        template<typename U>
+        void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>)
+        {
+            ::new (static_cast<void*>(p)) U;
+        }
+
+        template<typename U, typename... Args>
+        void construct(U* p, Args&&... args)
+        {
+            base_traits::construct(static_cast<Base&>(*this), p, std::forward<Args>(args)...);
+        }
+    };
+
+    namespace detail
+    {
+        /** An (ID, generation) pair laid out according to Traits.
+         *  Packed into a single key_type word when that is smaller than the two separate fields.
+         */
+        template<typename Traits,
+                 bool Packed = !std::is_same_v<typename Traits::key_type, no_key>
+                            && (sizeof(typename Traits::key_type)
+                                < sizeof(std::pair<typename Traits::id_type, typename Traits::generation_type>))>
+        struct id_generation_pair
+        {
+            using id_type         = typename Traits::id_type;
+            using generation_type = typename Traits::generation_type;
+
+            id_generation_pair() = default;
+
+            id_generation_pair(id_type id, generation_type generation)
+                : m_id{id}
+                , m_generation{generation}
+            {}
+
+            [[nodiscard]] id_type         id()         const noexcept { return m_id;         }
+            [[nodiscard]] generation_type generation() const noexcept { return m_generation; }
+
+            void set_id(id_type id) noexcept                       { m_id = id;                 }
+            void set_generation(generation_type generation) noexcept { m_generation = generation; }
+
+        private:
+            id_type         m_id         = 0;
+            generation_type m_generation = 0;
+        };
+
+        template<typename Traits>
+        struct id_generation_pair<Traits, true>
+        {
+            using id_type         = typename Traits::id_type;
+            using generation_type = typename Traits::generation_type;
+            using key_type        = typename Traits::key_type;
+
+            static constexpr key_type id_mask = static_cast<key_type>(low_mask<Traits::id_bits>);
+
+            id_generation_pair() = default;
+
+            id_generation_pair(id_type id, generation_type generation)
+                : m_bits{static_cast<key_type>(id | (static_cast<key_type>(generation) << Traits::id_bits))}
+            {}
+
+            [[nodiscard]] id_type         id()         const noexcept { return static_cast<id_type>(m_bits & id_mask);                  }
+            [[nodiscard]] generation_type generation() const noexcept { return static_cast<generation_type>(m_bits >> Traits::id_bits); }
+
+            void set_id(id_type id) noexcept
+            {
+                m_bits = static_cast<key_type>((m_bits & ~id_mask) | id);
+            }
+
+            void set_generation(generation_type generation) noexcept
+            {
+                m_bits = static_cast<key_type>((m_bits & id_mask) | (static_cast<key_type>(generation) << Traits::id_bits));
+            }
+
+        private:
+            key_type m_bits = 0;
+        };
+
+        /// Detects storages split in pages (see siv::paged_storage)
+        template<typename S, typename = void>
+        struct is_paged_storage : std::false_type {};
+
+        template<typename S>
+        struct is_paged_storage<S, std::void_t<decltype(std::declval<const S&>().page_count())>> : std::true_type {};
+
+        /// Detects storages that can grow by value- or default-initialized elements in one call
+        template<typename S, typename = void>
+        struct has_resize : std::false_type {};
+
+        template<typename S>
+        struct has_resize<S, std::void_t<decltype(std::declval<S&>().resize(std::size_t{}))>> : std::true_type {};
+
+        /// Detects storages holding their elements in one contiguous array
+        template<typename S, typename = void>
+        struct has_data : std::false_type {};
+
+        template<typename S>
+        struct has_data<S, std::void_t<decltype(std::declval<const S&>().data())>> : std::true_type {};
+
+        /// Whether S relocates its elements with memcpy (see siv::relocating_storage)
+        template<typename S, typename = void>
+        struct relocates : std::false_type {};
+
+        template<typename S>
+        struct relocates<S, std::enable_if_t<S::trivially_relocatable>> : std::true_type {};
+
+        /** Makes room for `n` more elements with geometric growth, capped at max_size().
+         *  Reserving exactly size() + n would reallocate on every insertion.
+         */
+        template<typename Container>
+        void reserve_more(Container& c, std::size_t n)
+        {
+            if (c.size() + n > c.capacity()) {
+                const std::size_t grown = std::min<std::size_t>(std::max<std::size_t>(c.capacity() * 2, 16), c.max_size());
+                c.reserve(std::max<std::size_t>(grown, c.size() + n));
+            }
+        }
+
+        template<typename Container>
+        void reserve_one_more(Container& c)
+        {
+            reserve_more(c, 1);
+        }
+
+        /// Stand-in member for features disabled by the traits
+        struct empty_member {};
+
+        /// Number of lookups a batch lookup prefetches ahead, for index entries and again for elements
+        inline constexpr std::size_t prefetch_distance = 32;
+
+        /// Hints that `address` is about to be read; a no-op where no prefetch instruction is available
+        inline void prefetch(const void* address) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+            (void)address;
+#endif
+        }
+
+        /// Index of the highest set bit of `x`, which must not be zero
+        [[nodiscard]]
+        inline unsigned floor_log2(uint64_t x) noexcept
+        {
+            assert(x != 0 && "floor_log2(0)");
+#if defined(__GNUC__) || defined(__clang__)
+            return 63u - static_cast<unsigned>(__builtin_clzll(x));
+#else
+            unsigned bit = 0;
+            while (x >>= 1) {
+                ++bit;
+            }
+            return bit;
+#endif
+        }
+
+        /// Instruction sets the bulk handle validation can run on, selected at runtime
+        enum class simd_isa
+        {
+            scalar,
+            avx2,
+            avx512
+        };
+
+        /// Widest instruction set supported by the running CPU (scalar off x86-64 or with SIV_NO_SIMD)
+        [[nodiscard]]
+        inline simd_isa detected_simd_isa() noexcept
+        {
+#if SIV_X86_SIMD
+            static const simd_isa isa = [] {
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f")) {
+                    return simd_isa::avx512;
+                }
+                return __builtin_cpu_supports("avx2") ? simd_isa::avx2 : simd_isa::scalar;
+            }();
+            return isa;
+#else
+            return simd_isa::scalar;
+#endif
+        }
+
+#if SIV_X86_SIMD
+        /// Stores bit k of `bits` as out[k], for k in [0, lanes): each byte is 0 or 1, as a bool is
+        inline void store_mask(bool* out, unsigned bits, std::size_t lanes) noexcept
+        {
+            for (std::size_t b{0}; b < lanes; b += 8) {
+                std::uint64_t bytes = (((bits >> b) & 0xFFu) * 0x0101010101010101ull) & 0x8040201008040201ull;
+                bytes = ((bytes + 0x7F7F7F7F7F7F7F7Full) >> 7) & 0x0101010101010101ull;
+                std::memcpy(out + b, &bytes, std::min<std::size_t>(8, lanes - b));
+            }
+        }
+
+        /** Gather kernels of id_table::validate() for `n` pairs, `n` being a multiple of the lane count.
+         *  Lane is the common width of IDs and generations (4 or 8 bytes). `positions` holds the
+         *  position of each ID (every other Lane with a co-located layout), and `generations` the
+         *  generation of each position, or of each ID when Colocated, every other Lane.
+         *  @return The number of valid pairs
+         */
+        template<bool Colocated, typename Lane>
+        __attribute__((target("avx2")))
+        std::size_t validate_avx2(const Lane* ids, const Lane* gens, std::size_t n, const Lane* positions,
+                                  const Lane* generations, std::size_t index_count, std::size_t size, bool* out) noexcept
+        {
+            std::size_t valid{0};
+            const __m256i zero = _mm256_setzero_si256();
+            if constexpr (sizeof(Lane) == 8) {
+                // No unsigned 64-bit compare in AVX2: flip the sign bits and compare signed
+                const __m256i sign  = _mm256_set1_epi64x(std::numeric_limits<long long>::min());
+                const __m256i count = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(index_count)), sign);
+                const __m256i live  = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(size)), sign);
+                const auto*   pos_base = reinterpret_cast<const long long*>(positions);
+                const auto*   gen_base = reinterpret_cast<const long long*>(generations);
+                for (std::size_t i{0}; i < n; i += 4) {
+                    const __m256i id    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + i));
+                    const __m256i gen   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gens + i));
+                    const __m256i known = _mm256_cmpgt_epi64(count, _mm256_xor_si256(id, sign));
+                    const __m256i slot  = Colocated ? _mm256_add_epi64(id, id) : id;
+                    const __m256i pos   = _mm256_mask_i64gather_epi64(zero, pos_base, slot, known, 8);
+                    __m256i ok = _mm256_and_si256(known, _mm256_cmpgt_epi64(live, _mm256_xor_si256(pos, sign)));
+                    const __m256i key = Colocated ? id : pos;
+                    const __m256i current = _mm256_mask_i64gather_epi64(zero, gen_base, _mm256_add_epi64(key, key), ok, 8);
+                    ok = _mm256_and_si256(ok, _mm256_cmpeq_epi64(current, gen));
+                    const auto bits = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(ok)));
+                    store_mask(out + i, bits, 4);
+                    valid += static_cast<std::size_t>(__builtin_popcount(bits));
+                }
+            } else {
+                const __m256i sign  = _mm256_set1_epi32(std::numeric_limits<int>::min());
+                const __m256i count = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(index_count)), sign);
+                const __m256i live  = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(size)), sign);
+                const auto*   pos_base = reinterpret_cast<const int*>(positions);
+                const auto*   gen_base = reinterpret_cast<const int*>(generations);
+                for (std::size_t i{0}; i < n; i += 8) {
+                    const __m256i id    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + i));
+                    const __m256i gen   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(gens + i));
+                    const __m256i known = _mm256_cmpgt_epi32(count, _mm256_xor_si256(id, sign));
+                    const __m256i slot  = Colocated ? _mm256_add_epi32(id, id) : id;
+                    const __m256i pos   = _mm256_mask_i32gather_epi32(zero, pos_base, slot, known, 4);
+                    __m256i ok = _mm256_and_si256(known, _mm256_cmpgt_epi32(live, _mm256_xor_si256(pos, sign)));
+                    const __m256i key = Colocated ? id : pos;
+                    const __m256i current = _mm256_mask_i32gather_epi32(zero, gen_base, _mm256_add_epi32(key, key), ok, 4);
+                    ok = _mm256_and_si256(ok, _mm256_cmpeq_epi32(current, gen));
+                    const auto bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(ok)));
+                    store_mask(out + i, bits, 8);
+                    valid += static_cast<std::size_t>(__builtin_popcount(bits));
+                }
+            }
+            return valid;
+        }
+
+        /// AVX-512 version of validate_avx2(), with twice the lanes and native unsigned compares
+        template<bool Colocated, typename Lane>
+        __attribute__((target("avx512f")))
+        std::size_t validate_avx512(const Lane* ids, const Lane* gens, std::size_t n, const Lane* positions,
+                                    const Lane* generations, std::size_t index_count, std::size_t size, bool* out) noexcept
+        {
+            std::size_t valid{0};
+            const __m512i zero = _mm512_setzero_si512();
+            if constexpr (sizeof(Lane) == 8) {
+                const __m512i count = _mm512_set1_epi64(static_cast<long long>(index_count));
+                const __m512i live  = _mm512_set1_epi64(static_cast<long long>(size));
+                for (std::size_t i{0}; i < n; i += 8) {
+                    const __m512i  id    = _mm512_loadu_si512(ids + i);
+                    const __m512i  gen   = _mm512_loadu_si512(gens + i);
+                    const __mmask8 known = _mm512_cmplt_epu64_mask(id, count);
+                    const __m512i  slot  = Colocated ? _mm512_add_epi64(id, id) : id;
+                    const __m512i  pos   = _mm512_mask_i64gather_epi64(zero, known, slot, positions, 8);
+                    __mmask8 ok = _mm512_mask_cmplt_epu64_mask(known, pos, live);
+                    const __m512i key = Colocated ? id : pos;
+                    const __m512i current = _mm512_mask_i64gather_epi64(zero, ok, _mm512_add_epi64(key, key), generations, 8);
+                    ok = _mm512_mask_cmpeq_epi64_mask(ok, current, gen);
+                    store_mask(out + i, ok, 8);
+                    valid += static_cast<std::size_t>(__builtin_popcount(ok));
+                }
+            } else {
+                const __m512i count = _mm512_set1_epi32(static_cast<int>(index_count));
+                const __m512i live  = _mm512_set1_epi32(static_cast<int>(size));
+                for (std::size_t i{0}; i < n; i += 16) {
+                    const __m512i   id    = _mm512_loadu_si512(ids + i);
+                    const __m512i   gen   = _mm512_loadu_si512(gens + i);
+                    const __mmask16 known = _mm512_cmplt_epu32_mask(id, count);
+                    const __m512i   slot  = Colocated ? _mm512_add_epi32(id, id) : id;
+                    const __m512i   pos   = _mm512_mask_i32gather_epi32(zero, known, slot, positions, 4);
+                    __mmask16 ok = _mm512_mask_cmplt_epu32_mask(known, pos, live);
+                    const __m512i key = Colocated ? id : pos;
+                    const __m512i current = _mm512_mask_i32gather_epi32(zero, ok, _mm512_add_epi32(key, key), generations, 4);
+                    ok = _mm512_mask_cmpeq_epi32_mask(ok, current, gen);
+                    store_mask(out + i, ok, 16);
+                    valid += static_cast<std::size_t>(__builtin_popcount(ok));
+                }
+            }
+            return valid;
+        }
+#endif
+
+#if SIV_COROUTINES
+        /// Number of lookups experimental::for_each_interleaved() keeps in flight by default
+        inline constexpr std::size_t interleave_group = 16;
+
+        /** Coroutine running one stream of interleaved lookups. It starts suspended and is resumed by
+         *  its owner until done. An exception escaping the coroutine is rethrown by resume().
+         */
+        class lookup_stream
+        {
+        public:
+            struct promise_type
+            {
+                lookup_stream get_return_object() noexcept
+                {
+                    return lookup_stream(std::coroutine_handle<promise_type>::from_promise(*this));
+                }
+
+                std::suspend_always initial_suspend() const noexcept { return {}; }
+                std::suspend_always final_suspend()   const noexcept { return {}; }
+                void return_void() const noexcept {}
+
+                void unhandled_exception() noexcept
+                {
+#if SIV_EXCEPTIONS
+                    m_error = std::current_exception();
+#else
+                    std::terminate();
+#endif
+                }
+
+#if SIV_EXCEPTIONS
+                std::exception_ptr m_error;
+#endif
+            };
+
+            explicit lookup_stream(std::coroutine_handle<promise_type> handle) noexcept
+                : m_handle{handle}
+            {}
+
+            lookup_stream(lookup_stream&& other) noexcept
+                : m_handle{std::exchange(other.m_handle, {})}
+            {}
+
+            lookup_stream& operator=(lookup_stream&&) = delete;
+
+            ~lookup_stream()
+            {
+                if (m_handle) {
+                    m_handle.destroy();
+                }
+            }
+
+            [[nodiscard]]
+            bool done() const noexcept
+            {
+                return m_handle.done();
+            }
+
+            /// Runs the stream up to its next suspension point; returns false once it has finished
+            bool resume()
+            {
+                m_handle.resume();
+                if (!m_handle.done()) {
+                    return true;
+                }
+#if SIV_EXCEPTIONS
+                if (m_handle.promise().m_error) {
+                    std::rethrow_exception(m_handle.promise().m_error);
+                }
+#endif
+                return false;
+            }
+
+        private:
+            std::coroutine_handle<promise_type> m_handle;
+        };
+
+        /// Implements experimental::for_each_interleaved(), with access to the vector internals
+        struct interleaver
+        {
+            /// Round-robin scheduler: `group` streams share the cursor over `ids`
+            template<typename Vector, typename Fn>
+            static void run(Vector& vec, span<const typename Vector::id_type> ids, Fn& fn, std::size_t group)
+            {
+                assert(group > 0 && "Interleaving group must not be empty");
+                using stream_buffer = typename Vector::template scratch_type<lookup_stream>;
+                std::size_t next{0};
+                stream_buffer streams(vec.template scratch_allocator<lookup_stream>());
+                streams.reserve(std::min<std::size_t>(group, ids.size()));
+                for (std::size_t s{0}; s < std::min<std::size_t>(group, ids.size()); ++s) {
+                    streams.push_back(lookup(vec, ids, next, fn));
+                }
+                for (std::size_t active = streams.size(); active > 0;) {
+                    for (auto& stream : streams) {
+                        if (!stream.done() && !stream.resume()) {
+                            --active;
+                        }
+                    }
+                }
+            }
+
+            /// One stream: takes the next ID until none is left
+            template<typename Vector, typename Fn>
+            static lookup_stream lookup(Vector& vec, span<const typename Vector::id_type> ids, std::size_t& next, Fn& fn)
+            {
+                while (next < ids.size()) {
+                    const auto id = ids[next++];
+                    vec.m_ids.prefetch(id);
+                    co_await std::suspend_always{};
+                    const std::size_t pos = vec.m_ids.index(id);
+                    detail::prefetch(&vec.m_data[pos]);
+                    co_await std::suspend_always{};
+                    vec.invoke_element(fn, pos, vec.m_data[pos]);
+                }
+            }
+        };
+#endif
+
+#ifndef SIV_NO_THREADS
+        using mutex = std::mutex;
+#else
+        /// Stand-in for std::mutex when SIV_NO_THREADS leaves a single thread
+        struct mutex
+        {
+            void lock() noexcept {}
+            bool try_lock() noexcept { return true; }
+            void unlock() noexcept {}
+        };
+#endif
+
+        /// Unlocks, on scope exit, a mutex locked by the caller
+        class unlock_guard
+        {
+        public:
+            explicit unlock_guard(mutex& m) noexcept : m_mutex{m} {}
+            unlock_guard(const unlock_guard&)            = delete;
+            unlock_guard& operator=(const unlock_guard&) = delete;
+            ~unlock_guard() { m_mutex.unlock(); }
+
+        private:
+            mutex& m_mutex;
+        };
+
+        /// Backs off in a spin loop waiting on another thread: pauses first, then yields
+        inline void spin_wait(unsigned& spins) noexcept
+        {
+            if (++spins < 64) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+                __builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+                _mm_pause();
+#endif
+                return;
+            }
+#ifndef SIV_NO_THREADS
+            std::this_thread::yield();
+#endif
+        }
+
+        /** Starts a sequence-counter write: makes `version` odd before any store of the write.
+         *  Under ThreadSanitizer, which supports no fences, an acquire read-modify-write orders the
+         *  stores instead: see seqlock_unchanged().
+         */
+        inline void seqlock_begin_write(std::atomic<uint64_t>& version) noexcept
+        {
+#if SIV_TSAN
+            version.fetch_add(1, std::memory_order_acquire);
+#else
+            version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+#endif
+        }
+
+        /** Ends a sequence-counter read: whether `version` still holds `before` after the racy_copy()
+         *  loads. Under ThreadSanitizer, a release read-modify-write that changes nothing replaces
+         *  the fence: it precedes the writer's acquire increment in the counter's modification order,
+         *  and then the reads happen before the write, or it follows it and sees the new value.
+         */
+        inline bool seqlock_unchanged(std::atomic<uint64_t>& version, uint64_t before) noexcept
+        {
+#if SIV_TSAN
+            return version.fetch_add(0, std::memory_order_release) == before;
+#else
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return version.load(std::memory_order_relaxed) == before;
+#endif
+        }
+
+        /** Copies `n` bytes that another thread may be writing, as relaxed atomic loads. The copy can
+         *  be torn: callers discard it unless a sequence counter shows that no write overlapped.
+         *  Not instrumented by ThreadSanitizer, which cannot model this validation.
+         */
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((no_sanitize_thread))
+#endif
+        inline void racy_copy(void* dst, const void* src, std::size_t n) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            auto* out = static_cast<unsigned char*>(dst);
+            const auto* in = static_cast<const unsigned char*>(src);
+            if (reinterpret_cast<std::uintptr_t>(in) % sizeof(uint64_t) == 0) {
+                using word = uint64_t __attribute__((may_alias));
+                for (; n >= sizeof(word); n -= sizeof(word), in += sizeof(word), out += sizeof(word)) {
+                    const word w = __atomic_load_n(reinterpret_cast<const word*>(in), __ATOMIC_RELAXED);
+                    std::memcpy(out, &w, sizeof(word));
+                }
+            }
+            for (; n > 0; --n, ++in, ++out) {
+                *out = __atomic_load_n(in, __ATOMIC_RELAXED);
+            }
+#else
+            std::memcpy(dst, src, n);
+#endif
+        }
+
+        /** Memory handed out by siv::detail::retiring_allocator. Deallocated blocks are only queued,
+         *  so that threads still reading them never touch freed memory, and returned to `Base` by
+         *  reclaim(). Each block starts with a hidden header linking it into the queue.
+         */
+        template<typename Base>
+        class retired_memory
+        {
+        public:
+            explicit retired_memory(const Base& base)
+                : m_allocator(base)
+            {}
+
+            retired_memory(const retired_memory&)            = delete;
+            retired_memory& operator=(const retired_memory&) = delete;
+
+            ~retired_memory()
+            {
+                reclaim();
+            }
+
+            [[nodiscard]]
+            void* allocate(std::size_t bytes)
+            {
+                if (bytes > (std::numeric_limits<std::size_t>::max)() - 2 * sizeof(unit)) {
+#if SIV_EXCEPTIONS
+                    throw std::bad_alloc();
+#else
+                    assert(false && "siv: allocation too large");
+#endif
+                }
+                const std::size_t units = 1 + (bytes + sizeof(unit) - 1) / sizeof(unit);
+                unit* block = unit_traits::allocate(m_allocator, units);
+                ::new (static_cast<void*>(block)) header{nullptr, units};
+                return block + 1;
+            }
+
+            /// Queues the block at `p` instead of freeing it
+            void retire(void* p) noexcept
+            {
+                header* h = std::launder(reinterpret_cast<header*>(static_cast<unit*>(p) - 1));
+                h->next     = m_retired;
+                m_retired   = h;
+                m_retired_bytes += (h->units - 1) * sizeof(unit);
+            }
+
+            /// Frees every queued block. No thread may still read one.
+            void reclaim() noexcept
+            {
+                while (m_retired) {
+                    header* h = m_retired;
+                    m_retired = h->next;
+                    unit_traits::deallocate(m_allocator, reinterpret_cast<unit*>(h), h->units);
+                }
+                m_retired_bytes = 0;
+            }
+
+            [[nodiscard]]
+            std::size_t retired_bytes() const noexcept
+            {
+                return m_retired_bytes;
+            }
+
+        private:
+            struct alignas(std::max_align_t) unit
+            {
+                unsigned char bytes[alignof(std::max_align_t) < 16 ? 16 : alignof(std::max_align_t)];
+            };
+
+            struct header
+            {
+                header*     next;
+                std::size_t units;
+            };
+            static_assert(sizeof(header) <= sizeof(unit), "Block header must fit in one unit");
+
+            using unit_allocator = typename std::allocator_traits<Base>::template rebind_alloc<unit>;
+            using unit_traits    = std::allocator_traits<unit_allocator>;
+
+            unit_allocator m_allocator;
+            header*        m_retired{nullptr};
+            std::size_t    m_retired_bytes{0};
+        };
+
+        /// Allocator drawing from a siv::detail::retired_memory, whose deallocate() defers the free
+        template<typename U, typename Base>
+        class retiring_allocator
+        {
+        public:
+            using value_type = U;
+
+            template<typename V>
+            struct rebind
+            {
+                using other = retiring_allocator<V, Base>;
+            };
+
+            explicit retiring_allocator(retired_memory<Base>* memory) noexcept
+                : m_memory{memory}
+            {}
+
+            template<typename V>
+            retiring_allocator(const retiring_allocator<V, Base>& other) noexcept
+                : m_memory{other.m_memory}
+            {}
+
+            [[nodiscard]]
+            U* allocate(std::size_t n)
+            {
+                static_assert(alignof(U) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+                if (n > (std::numeric_limits<std::size_t>::max)() / sizeof(U)) {
+#if SIV_EXCEPTIONS
+                    throw std::bad_alloc();
+#else
+                    assert(false && "siv: allocation too large");
+#endif
+                }
+                return static_cast<U*>(m_memory->allocate(n * sizeof(U)));
+            }
+
+            void deallocate(U* p, std::size_t) noexcept
+            {
+                m_memory->retire(p);
+            }
+
+            template<typename V>
+            bool operator==(const retiring_allocator<V, Base>& other) const noexcept
+            {
+                return m_memory == other.m_memory;
+            }
+
+            template<typename V>
+            bool operator!=(const retiring_allocator<V, Base>& other) const noexcept
+            {
+                return m_memory != other.m_memory;
+            }
+
+        private:
+            template<typename, typename>
+            friend class retiring_allocator;
+
+            retired_memory<Base>* m_memory;
+        };
+
+        /** Number of elements below which a parallel operation stays on the calling thread. Starting
+         *  and joining a thread costs tens of microseconds, so a chunk must be large enough for
+         *  cheap per-element work to outweigh it.
+         */
+        inline constexpr std::size_t parallel_grain = SIV_PARALLEL_GRAIN;
+        static_assert(parallel_grain > 0, "SIV_PARALLEL_GRAIN must be positive");
+
+        /// Number of chunks a parallel operation over `n` elements is split into
+        [[nodiscard]]
+        inline std::size_t parallel_chunks(std::size_t n) noexcept
+        {
+#ifndef SIV_NO_THREADS
+            // hardware_concurrency() is a system call on some platforms; it is queried once
+            static const std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+            return std::max<std::size_t>(std::min(threads, n / parallel_grain), 1);
+#else
+            (void)n;
+            return 1;
+#endif
+        }
+
+        /** Runs task(i) for every i in [0, count), task(0) on the calling thread and the others on
+         *  worker threads. If a worker cannot be started its task runs inline instead. The first
+         *  exception thrown by a task is rethrown once every task has finished.
+         */
+        template<typename Task>
+        void parallel_tasks(std::size_t count, Task&& task)
+        {
+#ifndef SIV_NO_THREADS
+            if (count > 1) {
+#if SIV_EXCEPTIONS
+                std::vector<std::exception_ptr> errors(count);
+                auto run = [&](std::size_t i) {
+                    try {
+                        task(i);
+                    } catch (...) {
+                        errors[i] = std::current_exception();
+                    }
+                };
+#else
+                auto run = [&](std::size_t i) { task(i); };
+#endif
+                std::vector<std::thread> workers;
+                workers.reserve(count - 1);
+                for (std::size_t i{1}; i < count; ++i) {
+#if SIV_EXCEPTIONS
+                    try {
+                        workers.emplace_back(run, i);
+                    } catch (...) {
+                        run(i);
+                    }
+#else
+                    workers.emplace_back(run, i);
+#endif
+                }
+                run(0);
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+#if SIV_EXCEPTIONS
+                for (const auto& error : errors) {
+                    if (error) {
+                        std::rethrow_exception(error);
+                    }
+                }
+#endif
+                return;
+            }
+#endif
+            for (std::size_t i{0}; i < count; ++i) {
+                task(i);
+            }
+        }
+
+        /// Runs fn(begin, end) over contiguous chunks of [0, n), one chunk per thread
+        template<typename Fn>
+        void parallel_for(std::size_t n, Fn&& fn)
+        {
+            const std::size_t chunks = parallel_chunks(n);
+            parallel_tasks(chunks, [&](std::size_t c) {
+                fn(c * n / chunks, (c + 1) * n / chunks);
+            });
+        }
+
+        /** Sorts [first, first + n): chunks are sorted concurrently, then merged pairwise, each
+         *  merge round running in parallel. std::merge favours the left run on ties, so a Stable
+         *  sort remains stable.
+         */
+        template<bool Stable, typename Value, typename Compare>
+        void parallel_sort(Value* first, std::size_t n, Compare comp)
+        {
+            auto sort_run = [&comp](Value* begin, Value* end) {
+                if constexpr (Stable) {
+                    std::stable_sort(begin, end, comp);
+                } else {
+                    std::sort(begin, end, comp);
+                }
+            };
+            const std::size_t chunks = parallel_chunks(n);
+            if (chunks <= 1) {
+                sort_run(first, first + n);
+                return;
+            }
+            std::vector<std::size_t> bounds(chunks + 1);
+            for (std::size_t c{0}; c <= chunks; ++c) {
+                bounds[c] = c * n / chunks;
+            }
+            parallel_tasks(chunks, [&](std::size_t c) {
+                sort_run(first + bounds[c], first + bounds[c + 1]);
+            });
+            std::vector<Value> buffer(n);
+            Value* src = first;
+            Value* dst = buffer.data();
+            while (bounds.size() > 2) {
+                const std::size_t runs = bounds.size() - 1;
+                parallel_tasks((runs + 1) / 2, [&](std::size_t pair) {
+                    const std::size_t lo  = bounds[2 * pair];
+                    const std::size_t mid = bounds[std::min(2 * pair + 1, runs)];
+                    const std::size_t hi  = bounds[std::min(2 * pair + 2, runs)];
+                    std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo, comp);
+                });
+                std::vector<std::size_t> merged;
+                for (std::size_t i{0}; i < runs; i += 2) {
+                    merged.push_back(bounds[i]);
+                }
+                merged.push_back(n);
+                bounds = std::move(merged);
+                std::swap(src, dst);
+            }
+            if (src != first) {
+                std::copy(src, src + n, first);
+            }
+        }
+
+        /// Checks that `perm` holds every index of [0, perm.size()) exactly once
+        template<typename Index>
+        [[nodiscard]]
+        bool is_permutation(const Index* perm, std::size_t n)
+        {
+            std::vector<bool> seen(n, false);
+            for (std::size_t i{0}; i < n; ++i) {
+                if (perm[i] >= n || seen[perm[i]]) {
+                    return false;
+                }
+                seen[perm[i]] = true;
+            }
+            return true;
+        }
+
+        /** Bidirectional iterator over a slot sequence that skips the slots flagged as dead.
+         *
+         * @tparam Base The underlying slot iterator
+         * @tparam Flags The per-slot dead flags container
+         */
+        template<typename Base, typename Flags>
+        class live_iterator
+        {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type        = typename std::iterator_traits<Base>::value_type;
+            using difference_type   = typename std::iterator_traits<Base>::difference_type;
+            using pointer           = typename std::iterator_traits<Base>::pointer;
+            using reference         = typename std::iterator_traits<Base>::reference;
+
+            live_iterator() = default;
+
+            /// Positions the iterator on the first live slot at or after `pos`
+            live_iterator(Base it, const Flags* dead, std::size_t pos, std::size_t end)
+                : m_it{it}
+                , m_dead{dead}
+                , m_pos{pos}
+                , m_end{end}
+            {
+                while (m_pos < m_end && (*m_dead)[m_pos]) {
+                    ++m_it;
+                    ++m_pos;
+                }
+            }
+
+            /// Allows iterator -> const_iterator conversion
+            template<typename Other, typename = std::enable_if_t<!std::is_same_v<Other, Base>
+                                                              && std::is_convertible_v<Other, Base>>>
+            live_iterator(const live_iterator<Other, Flags>& other)
+                : m_it{other.m_it}
+                , m_dead{other.m_dead}
+                , m_pos{other.m_pos}
+                , m_end{other.m_end}
+            {}
+
+            reference operator*()  const { return *m_it; }
+            pointer   operator->() const { return &*m_it; }
+
+            live_iterator& operator++()
+            {
+                do {
+                    ++m_it;
+                    ++m_pos;
+                } while (m_pos < m_end && (*m_dead)[m_pos]);
+                return *this;
+            }
+
+            live_iterator& operator--()
+            {
+                do {
+                    --m_it;
+                    --m_pos;
+                } while ((*m_dead)[m_pos]);
+                return *this;
+            }
+
+            live_iterator operator++(int) { auto it = *this; ++*this; return it; }
+            live_iterator operator--(int) { auto it = *this; --*this; return it; }
+
+            friend bool operator==(const live_iterator& a, const live_iterator& b) { return a.m_pos == b.m_pos; }
+            friend bool operator!=(const live_iterator& a, const live_iterator& b) { return a.m_pos != b.m_pos; }
+
+            /// Slot position of the iterator in the underlying storage
+            [[nodiscard]]
+            std::size_t position() const noexcept
+            {
+                return m_pos;
+            }
+
+        private:
+            Base          m_it{};
+            const Flags*  m_dead = nullptr;
+            std::size_t   m_pos  = 0;
+            std::size_t   m_end  = 0;
+
+            template<typename, typename>
+            friend class live_iterator;
+        };
+
+        /** Free IDs in the order a recycle_policy hands them out. Storage is a std::vector-like sequence.
+         *  recycle_policy::fifo uses a growable ring buffer, recycle_policy::lowest_id a min-heap.
+         *  prepare() makes room up front, so that push() cannot fail once the tables were modified.
+         */
+        template<recycle_policy Policy, typename Storage>
+        class free_id_queue
+        {
+        public:
+            using size_type = std::size_t;
+            using id_type   = typename Storage::value_type;
+
+            free_id_queue() = default;
+
+            explicit free_id_queue(Storage storage)
+                : m_ids(std::move(storage))
+            {}
+
+            [[nodiscard]] size_type size()  const noexcept { return m_count;      }
+            [[nodiscard]] bool      empty() const noexcept { return m_count == 0; }
+
+            /// Makes room for `n` more IDs
+            void prepare(size_type n)
+            {
+                if constexpr (Policy == recycle_policy::fifo) {
+                    if (m_count + n <= m_ids.size()) {
+                        return;
+                    }
+                    // Unroll the ring so that the new slots land after its last element
+                    std::rotate(m_ids.begin(), m_ids.begin() + static_cast<std::ptrdiff_t>(m_head), m_ids.end());
+                    m_head = 0;
+                    m_ids.reserve(std::min<size_type>(std::max({m_ids.size() * 2, m_count + n, size_type{16}}), m_ids.max_size()));
+                    while (m_ids.size() < m_ids.capacity()) {
+                        m_ids.push_back(id_type{});
+                    }
+                } else {
+                    reserve_more(m_ids, n);
+                }
+            }
+
+            void push(id_type id) noexcept
+            {
+                assert(room() > 0 && "prepare() before push()");
+                if constexpr (Policy == recycle_policy::fifo) {
+                    m_ids[(m_head + m_count) % m_ids.size()] = id;
+                } else {
+                    m_ids.push_back(id);
+                    std::push_heap(m_ids.begin(), m_ids.end(), std::greater<>{});
+                }
+                ++m_count;
+            }
+
+            [[nodiscard]]
+            id_type top() const noexcept
+            {
+                assert(!empty() && "No free ID");
+                if constexpr (Policy == recycle_policy::fifo) {
+                    return m_ids[m_head];
+                } else {
+                    return m_ids.front();
+                }
+            }
+
+            void pop() noexcept
+            {
+                assert(!empty() && "No free ID");
+                if constexpr (Policy == recycle_policy::fifo) {
+                    m_head = (m_head + 1) % m_ids.size();
+                } else {
+                    std::pop_heap(m_ids.begin(), m_ids.end(), std::greater<>{});
+                    m_ids.pop_back();
+                }
+                --m_count;
+            }
+
+            void clear() noexcept
+            {
+                if constexpr (Policy != recycle_policy::fifo) {
+                    m_ids.clear();
+                }
+                m_head  = 0;
+                m_count = 0;
+            }
+
+            void shrink_to_fit()
+            {
+                if constexpr (Policy == recycle_policy::fifo) {
+                    std::rotate(m_ids.begin(), m_ids.begin() + static_cast<std::ptrdiff_t>(m_head), m_ids.end());
+                    m_head = 0;
+                    while (m_ids.size() > m_count) {
+                        m_ids.pop_back();
+                    }
+                }
+                m_ids.shrink_to_fit();
+            }
+
+        private:
+            [[nodiscard]]
+            size_type room() const noexcept
+            {
+                if constexpr (Policy == recycle_policy::fifo) {
+                    return m_ids.size() - m_count;
+                } else {
+                    return m_ids.capacity() - m_ids.size();
+                }
+            }
+
+            Storage   m_ids;
+            size_type m_head  = 0;
+            size_type m_count = 0;
+        };
+
+        /// Metadata entry holding only the owning ID, used when generations live in the index table
+        template<typename Traits>
+        struct rid_entry
+        {
+            using id_type = typename Traits::id_type;
+
+            rid_entry() = default;
+
+            explicit rid_entry(id_type id)
+                : m_id{id}
+            {}
+
+            [[nodiscard]] id_type id() const noexcept { return m_id; }
+
+            void set_id(id_type id) noexcept { m_id = id; }
+
+        private:
+            id_type m_id = 0;
+        };
+
+        /** Stable-ID bookkeeping shared by the siv containers.
+         *  m_indexes maps each ID to a position in m_metadata, and m_metadata[pos] records the ID
+         *  owning that position. The generation of an ID lives in m_metadata next to the ID, or,
+         *  with Traits::colocated_generation, in m_indexes next to the position so that a handle
+         *  is validated with a single load. m_metadata is partitioned by position:
+         *    [0, size)                      live, mirrors the element storage
+         *    [size, metadata - retired)     free IDs waiting to be recycled
+         *    [metadata - retired, metadata) retired IDs whose generation is exhausted
+         *  IDs detached by detach() have no metadata entry at all until attach() links them back.
+         *  The table never stores the container size itself: callers pass the size of their
+         *  element storage, so a failed element construction cannot desynchronize the two.
+         *
+         * @tparam Traits The ID/generation width and layout policy
+         * @tparam Allocator The container allocator, rebound for the internal vectors
+         */
+        template<typename Traits, typename Allocator>
+        class id_table
+        {
+        public:
+            using size_type       = std::size_t;
+            using id_type         = typename Traits::id_type;
+            using generation_type = typename Traits::generation_type;
+
+            static constexpr bool colocated = Traits::colocated_generation;
+
+            using metadata    = std::conditional_t<colocated, rid_entry<Traits>, id_generation_pair<Traits>>;
+            using index_entry = std::conditional_t<colocated, id_generation_pair<Traits>, id_type>;
+
+            using metadata_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<metadata>;
+            using index_allocator_type    = typename std::allocator_traits<Allocator>::template rebind_alloc<index_entry>;
+            using id_allocator_type       = typename std::allocator_traits<Allocator>::template rebind_alloc<id_type>;
+
+            using metadata_storage = typename Traits::template table_storage<metadata, metadata_allocator_type>;
+            using index_storage    = typename Traits::template table_storage<index_entry, index_allocator_type>;
+
+            /// Starting generation of the IDs released by shrink(), from the lowest one not yet
+            /// created again (or the next run) up to `end`
+            struct floor_run
+            {
+                id_type         end;
+                generation_type floor;
+            };
+
+            using floor_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<floor_run>;
+            using floor_storage        = typename Traits::template table_storage<floor_run, floor_allocator_type>;
+
+            /// Whether validate() can gather from the tables: contiguous, unpacked, one common lane width
+            static constexpr bool simd_layout = std::is_same_v<id_type, generation_type>
+                                             && (sizeof(id_type) == 4 || sizeof(id_type) == 8)
+                                             && detail::has_data<metadata_storage>::value
+                                             && detail::has_data<index_storage>::value
+                                             && (colocated ? sizeof(index_entry) == 2 * sizeof(id_type)
+                                                           : sizeof(index_entry) == sizeof(id_type)
+                                                          && sizeof(metadata) == 2 * sizeof(id_type));
+
+            /// LIFO recycling reads the next free ID straight from the free region; the others queue them
+            static constexpr bool tracks_free = Traits::recycle_mode != recycle_policy::lifo;
+
+            using free_ids_type = std::conditional_t<tracks_free,
+                                                     free_id_queue<Traits::recycle_mode,
+                                                                   typename Traits::template table_storage<id_type, id_allocator_type>>,
+                                                     empty_member>;
+
+            /// All-ones ID of the configured width, never handed out
+            static constexpr id_type invalid_id = static_cast<id_type>(low_mask<Traits::id_bits>);
+
+            /// Largest representable generation
+            static constexpr generation_type max_generation = static_cast<generation_type>(low_mask<Traits::generation_bits>);
+
+            id_table() = default;
+
+            explicit id_table(const Allocator& alloc)
+                : m_metadata(metadata_allocator_type(alloc))
+                , m_indexes(index_allocator_type(alloc))
+                , m_free(make_free_ids(alloc))
+                , m_floors(floor_allocator_type(alloc))
+            {}
+
+            void reserve(size_type new_cap)
+            {
+                m_metadata.reserve(new_cap);
+                m_indexes.reserve(new_cap);
+            }
+
+            /// Makes room for `n` more fresh IDs, so that the next `n` acquire() calls do not allocate
+            void reserve_more(size_type n)
+            {
+                detail::reserve_more(m_indexes, n);
+                detail::reserve_more(m_metadata, n);
+            }
+
+            /** Assigns a free ID (recycled first) to the data position `pos`
+             *  @param pos The position the new element will occupy, i.e. the current size
+             */
+            id_type acquire(size_type pos)
+            {
+                const id_type id = get_free_id(pos);
+                set_position(id, pos);
+                return id;
+            }
+
+            /** Assigns IDs to the `n` positions starting at `first`, like `n` calls to acquire().
+             *  With LIFO recycling, recycled IDs already sit at the positions they are handed out
+             *  for, so they only get their generation bumped, in one sequential pass.
+             *  @param out Receives the IDs, or nullptr
+             */
+            void acquire_n(size_type first, size_type n, id_type* out)
+            {
+                size_type i = 0;
+                if constexpr (!tracks_free) {
+                    while (i < n && free_count(first + i) > Traits::quarantine) {
+                        const size_type pos = first + i;
+                        if (!reusable_at(pos)) {
+                            retire(pos);
+                            continue;
+                        }
+                        bump_generation_at(pos);
+                        if (out) {
+                            out[i] = m_metadata[pos].id();
+                        }
+                        ++i;
+                    }
+                }
+                for (; i < n; ++i) {
+                    const id_type id = acquire(first + i);
+                    if (out) {
+                        out[i] = id;
+                    }
+                }
+            }
+
+            /** Gives back the IDs acquired for the positions [size, end) that got no element. They
+             *  already read as free; with recycling queues they are queued again, or retired.
+             *  Call prepare_release() before acquiring them, so that it cannot fail.
+             */
+            void release_unused(size_type size, size_type end) noexcept
+            {
+                if constexpr (tracks_free) {
+                    for (size_type pos = end; pos-- > size;) {
+                        free_or_retire(pos);
+                    }
+                } else {
+                    (void)size;
+                    (void)end;
+                }
+            }
+
+#if SIV_EXCEPTIONS
+            /** Gives back the ID acquired for the position `size` when its element could not be
+             *  constructed. If the recycling queue cannot grow, the ID is only left unqueued.
+             */
+            void cancel_acquire(size_type size) noexcept
+            {
+                try {
+                    prepare_release(1);
+                    release_unused(size, size + 1);
+                } catch (...) {
+                }
+            }
+#endif
+
+            /** Acquires an ID like acquire(), then detaches it: the ID keeps its index entry, reads as
+             *  dead and is never recycled, but has no metadata entry until attach() links it back.
+             *  The caller keeps its generation, which the metadata no longer holds.
+             *  @param size The current number of live positions
+             *  @param generation Receives the generation of the ID
+             */
+            id_type detach(size_type size, generation_type& generation)
+            {
+                const id_type id = get_free_id(size);
+                generation = this->generation(id);
+                // Move the entry past the retired tail, to the end of the table, and drop it
+                swap_positions(size, free_end() - 1);
+                if (m_retired > 0) {
+                    swap_positions(free_end() - 1, m_metadata.size() - 1);
+                }
+                m_metadata.pop_back();
+                set_position(id, detached_position);
+                ++m_detached;
+                return id;
+            }
+
+            /// Whether `id` was detached by detach() and not attached back yet
+            [[nodiscard]]
+            bool is_detached(id_type id) const noexcept
+            {
+                return id < m_indexes.size() && position(id) == detached_position;
+            }
+
+            /// Makes room for `count` attach() calls, so that they cannot fail
+            void prepare_attach(size_type count)
+            {
+                detail::reserve_more(m_metadata, count);
+                prepare_release(count);
+            }
+
+            /// Makes room for `count` release() calls, so that they cannot fail
+            void prepare_release(size_type count)
+            {
+                if constexpr (tracks_free) {
+                    m_free.prepare(count);
+                } else {
+                    (void)count;
+                }
+            }
+
+            /** Links a detached ID back with the generation it had when detached: at the live
+             *  position `size` if an element is being appended there, or as a free ID otherwise.
+             *  Call prepare_attach() first.
+             */
+            void attach(id_type id, generation_type generation, size_type size, bool live)
+            {
+                assert(is_detached(id) && "ID is not detached");
+                if constexpr (colocated) {
+                    (void)generation;
+                    link(metadata{id});
+                } else {
+                    link({id, generation});
+                }
+                --m_detached;
+                if (!live) {
+                    free_or_retire(free_end() - 1);
+                } else if (free_end() - 1 != size) {
+                    swap_positions(size, free_end() - 1);
+                }
+            }
+
+            /** Moves the bookkeeping of `id` to the last live position and bumps its generation.
+             *  The caller must then move its last element into the returned position and pop it.
+             *  @param id The stable ID to release
+             *  @param size The current number of live elements
+             *  @return The data index previously held by `id`
+             */
+            size_type release(id_type id, size_type size)
+            {
+                assert(id < m_indexes.size() && "ID out of range");
+                assert(position(id) < size && "Object already erased or ID invalid");
+                if constexpr (tracks_free) {
+                    m_free.prepare(1);
+                }
+                const size_type data_idx      = position(id);
+                const size_type last_data_idx = size - 1;
+                const id_type   last_id       = m_metadata[last_data_idx].id();
+                bump_generation(id);
+                std::swap(m_metadata[data_idx], m_metadata[last_data_idx]);
+                set_position(last_id, data_idx);
+                set_position(id, last_data_idx);
+                free_or_retire(last_data_idx);
+                return data_idx;
+            }
+
+            /** Batched release() in one pass over the live region: positions are scanned from both
+             *  ends and the last survivors fill the front holes, so the index table is only written
+             *  for moved survivors and released IDs. Released IDs get their generation bumped and are
+             *  recycled or retired, as with release(). `is_dead` is called at most once per position;
+             *  if it or `move` throws, the positions already found dead behind the moved survivors are
+             *  still released, and every other element stays live.
+             *  @param move Called as move(hole, survivor) so that the caller moves its element too
+             *  @param truncate Called once with the new size so that the caller drops its last elements
+             */
+            template<typename IsDead, typename Move, typename Truncate>
+            void release_where(size_type size, IsDead&& is_dead, Move&& move, Truncate&& truncate)
+            {
+                prepare_release(size);
+                size_type lo = 0;
+                size_type hi = size; // [hi, size) only holds released positions
+#if SIV_EXCEPTIONS
+                try {
+#endif
+                    while (true) {
+                        while (lo < hi && !is_dead(lo)) {
+                            ++lo;
+                        }
+                        if (lo == hi) {
+                            break;
+                        }
+                        while (hi - 1 > lo && is_dead(hi - 1)) {
+                            --hi;
+                        }
+                        if (hi - 1 == lo) {
+                            hi = lo;
+                            break;
+                        }
+                        // hi only passes the survivor once it is moved, so that a throwing move
+                        // leaves it live and its hole unreleased
+                        move(lo, hi - 1);
+                        swap_positions(lo, hi - 1);
+                        --hi;
+                        ++lo;
+                    }
+#if SIV_EXCEPTIONS
+                } catch (...) {
+                    release_tail(hi, size);
+                    truncate(hi);
+                    throw;
+                }
+#endif
+                release_tail(hi, size);
+                truncate(hi);
+            }
+
+            /** release_where() for a known list of live positions (ascending, unique): only the holes
+             *  below the new size are visited, in O(count).
+             */
+            template<typename Move, typename Truncate>
+            void release_positions(const size_type* dead, size_type count, size_type size, Move&& move, Truncate&& truncate)
+            {
+                assert(count <= size && "More positions than live elements");
+                prepare_release(count);
+                const size_type new_size = size - count;
+                size_type tail = count;
+                size_type src  = size;
+                for (size_type h{0}; h < count && dead[h] < new_size; ++h) {
+                    // Next survivor from the back, skipping the released positions of the tail
+                    --src;
+                    while (tail > 0 && dead[tail - 1] == src) {
+                        --tail;
+                        --src;
+                    }
+                    move(dead[h], src);
+                    swap_positions(dead[h], src);
+                }
+                release_tail(new_size, size);
+                truncate(new_size);
+            }
+
+            /** release_where() for flags computed beforehand (dead[pos] != 0), the holes being filled
+             *  by parallel chunks: the i-th hole below the new size receives the i-th survivor above it.
+             *  `move` is called from several threads at once, on disjoint positions, and must not throw.
+             */
+            template<typename Move, typename Truncate>
+            void release_flagged(size_type size, const unsigned char* dead, Move&& move, Truncate&& truncate)
+            {
+                const std::size_t chunks = parallel_chunks(size);
+                auto count_dead = [dead](size_type first, size_type last) {
+                    return static_cast<size_type>(std::count_if(dead + first, dead + last,
+                                                                [](unsigned char flag) { return flag != 0; }));
+                };
+                std::vector<size_type> dead_count(chunks);
+                parallel_tasks(chunks, [&](std::size_t c) {
+                    dead_count[c] = count_dead(c * size / chunks, (c + 1) * size / chunks);
+                });
+                const size_type count    = std::accumulate(dead_count.begin(), dead_count.end(), size_type{0});
+                const size_type new_size = size - count;
+                prepare_release(count);
+
+                // Rank of the first hole of each chunk of [0, new_size), and of the first survivor of each
+                // chunk of [new_size, size); both sequences end with the number of holes
+                std::vector<size_type> first_hole(chunks + 1);
+                std::vector<size_type> first_survivor(chunks + 1);
+                parallel_tasks(chunks, [&](std::size_t c) {
+                    first_hole[c + 1]     = count_dead(c * new_size / chunks, (c + 1) * new_size / chunks);
+                    const size_type begin = new_size + c * count / chunks;
+                    const size_type end   = new_size + (c + 1) * count / chunks;
+                    first_survivor[c + 1] = end - begin - count_dead(begin, end);
+                });
+                std::partial_sum(first_hole.begin(), first_hole.end(), first_hole.begin());
+                std::partial_sum(first_survivor.begin(), first_survivor.end(), first_survivor.begin());
+                assert(first_hole.back() == first_survivor.back() && "Holes and survivors do not match");
+
+                parallel_tasks(chunks, [&](std::size_t c) {
+                    size_type rank = first_hole[c];
+                    if (rank == first_hole[c + 1]) {
+                        return;
+                    }
+                    // Survivor chunk holding the survivor of the same rank, then that survivor
+                    const auto s  = static_cast<std::size_t>(
+                        std::upper_bound(first_survivor.begin(), first_survivor.end(), rank) - first_survivor.begin() - 1);
+                    size_type src = new_size + s * count / chunks;
+                    for (rank -= first_survivor[s];; ++src) {
+                        if (!dead[src] && rank-- == 0) {
+                            break;
+                        }
+                    }
+                    for (size_type pos = c * new_size / chunks, end = (c + 1) * new_size / chunks; pos < end; ++pos) {
+                        if (!dead[pos]) {
+                            continue;
+                        }
+                        while (dead[src]) {
+                            ++src;
+                        }
+                        move(pos, src);
+                        swap_positions(pos, src);
+                        ++src;
+                    }
+                });
+                release_tail(new_size, size);
+                truncate(new_size);
+            }
+
+            /** Erases `id` in place: bumps its generation but leaves its position in the live region.
+             *  The position is recycled only once compact() moves it past the survivors.
+             */
+            void kill(id_type id)
+            {
+                assert(id < m_indexes.size() && "ID out of range");
+                bump_generation(id);
+            }
+
+            /** Removes the killed positions from the live region [0, size) in one linear pass.
+             *  Survivors keep their relative order; the killed IDs become the front of the free IDs.
+             *  @param size The current number of slots
+             *  @param is_dead Predicate telling whether a (pre-compaction) position was killed
+             *  @return The number of surviving positions
+             */
+            template<typename IsDead>
+            size_type compact(size_type size, IsDead&& is_dead)
+            {
+                if constexpr (tracks_free) {
+                    size_type dead = 0;
+                    for (size_type pos{0}; pos < size; ++pos) {
+                        dead += is_dead(pos) ? 1 : 0;
+                    }
+                    m_free.prepare(dead);
+                }
+                size_type write = 0;
+                for (size_type pos{0}; pos < size; ++pos) {
+                    if (!is_dead(pos)) {
+                        // [write, pos) only holds killed entries: swapping keeps the survivors stable
+                        if (write != pos) {
+                            swap_positions(write, pos);
+                        }
+                        ++write;
+                    }
+                }
+                for (size_type pos = size; pos-- > write;) {
+                    free_or_retire(pos);
+                }
+                return write;
+            }
+
+            /** Reorders the live region so that position i receives the entry previously at perm[i],
+             *  then points every moved ID at its new position, in one pass over [0, size).
+             *  @param perm A permutation of [0, size)
+             */
+            template<bool Parallel>
+            void permute(const size_type* perm, size_type size)
+            {
+                std::vector<metadata> reordered(size);
+                auto gather = [&](size_type begin, size_type end) {
+                    for (size_type pos = begin; pos < end; ++pos) {
+                        reordered[pos] = m_metadata[perm[pos]];
+                    }
+                };
+                auto store = [&](size_type begin, size_type end) {
+                    for (size_type pos = begin; pos < end; ++pos) {
+                        m_metadata[pos] = reordered[pos];
+                        set_position(reordered[pos].id(), pos);
+                    }
+                };
+                if constexpr (Parallel) {
+                    detail::parallel_for(size, gather);
+                    detail::parallel_for(size, store);
+                } else {
+                    gather(0, size);
+                    store(0, size);
+                }
+            }
+
+            /** Releases the free IDs above every live and retired ID, then shrinks both tables.
+             *  The remaining free IDs are reordered lowest first, so that future insertions keep
+             *  the high IDs free for the next shrink. Live and retired IDs keep their generations.
+             *  A released ID created again starts above its own last generation, so a stale handle
+             *  to it cannot validate against its reincarnation. The starting generations are kept
+             *  as runs of consecutive IDs sharing one, so releasing IDs never ages the others.
+             *  @param size The current number of live positions
+             *  @return The number of released IDs
+             */
+            size_type shrink(size_type size)
+            {
+                if (m_detached > 0) {
+                    // Detached IDs have no metadata entry to keep them: leave the tables as they are
+                    return 0;
+                }
+                for (size_type pos = free_end(); pos-- > size;) {
+                    if (!reusable(m_metadata[pos].id())) {
+                        retire(pos);
+                    }
+                }
+                const size_type old_count = m_indexes.size();
+                const size_type free_stop = free_end();
+                // Every ID up to the highest live or retired one is kept
+                size_type kept = 0;
+                auto keep_range = [&](size_type begin, size_type end) {
+                    for (size_type pos = begin; pos < end; ++pos) {
+                        kept = std::max<size_type>(kept, size_type{m_metadata[pos].id()} + 1);
+                    }
+                };
+                keep_range(0, size);
+                keep_range(free_stop, old_count);
+                // Record the starting generation of each released ID, highest first, before touching
+                // the tables: above every handle ever made for it, as it may have been freed without a bump
+                auto floor_of = [this](size_type id) { return static_cast<generation_type>(generation(static_cast<id_type>(id)) + 1); };
+                size_type runs = 0;
+                bool has_back = m_floors.size() > 0;
+                generation_type back = has_back ? m_floors.back().floor : generation_type{0};
+                for (size_type id = old_count; id-- > kept;) {
+                    if (!has_back || floor_of(id) != back) {
+                        ++runs;
+                        has_back = true;
+                        back = floor_of(id);
+                    }
+                }
+                detail::reserve_more(m_floors, runs);
+                for (size_type id = old_count; id-- > kept;) {
+                    // The back run starts at the lowest ID not created again: extend it downwards when it can
+                    if (m_floors.size() == 0 || m_floors.back().floor != floor_of(id)) {
+                        m_floors.push_back({static_cast<id_type>(id + 1), floor_of(id)});
+                    }
+                }
+                // Compact the free region down to the kept IDs, then slide the retired tail after it
+                size_type write = size;
+                for (size_type pos = size; pos < free_stop; ++pos) {
+                    if (m_metadata[pos].id() < kept) {
+                        m_metadata[write++] = m_metadata[pos];
+                    }
+                }
+                const size_type new_free_end = write;
+                for (size_type pos = free_stop; pos < old_count; ++pos) {
+                    m_metadata[write++] = m_metadata[pos];
+                }
+                assert(write == kept && "ID table out of sync");
+                std::sort(m_metadata.begin() + static_cast<std::ptrdiff_t>(size),
+                          m_metadata.begin() + static_cast<std::ptrdiff_t>(new_free_end),
+                          [](const metadata& a, const metadata& b) { return a.id() < b.id(); });
+                for (size_type pos = size; pos < kept; ++pos) {
+                    set_position(m_metadata[pos].id(), pos);
+                }
+                while (m_metadata.size() > kept) {
+                    m_metadata.pop_back();
+                }
+                while (m_indexes.size() > kept) {
+                    m_indexes.pop_back();
+                }
+                m_metadata.shrink_to_fit();
+                m_indexes.shrink_to_fit();
+                m_floors.shrink_to_fit();
+                if constexpr (tracks_free) {
+                    m_free.clear();
+                    m_free.shrink_to_fit();
+                    queue_free_ids(size);
+                }
+                return old_count - kept;
+            }
+
+            /** Frees every live position at once, without touching the generations: an ID whose
+             *  position is past the live region already reads as dead, and recycling an ID bumps its
+             *  generation before any new handle can be made. The live region simply becomes the
+             *  front of the free region. O(1) with recycle_policy::lifo, otherwise O(size) to queue
+             *  the freed IDs. Call it before destroying the elements; on failure nothing changed.
+             *  @param size The current number of live positions
+             */
+            void release_all(size_type size)
+            {
+                if constexpr (tracks_free) {
+                    m_free.prepare(size);
+                    for (size_type pos = size; pos-- > 0;) {
+                        free_or_retire(pos);
+                    }
+                } else {
+                    (void)size;
+                }
+            }
+
+            /// Returns the ID owning the given data position
+            [[nodiscard]]
+            id_type rid(size_type pos) const
+            {
+                return m_metadata[pos].id();
+            }
+
+            /// Returns the generation of the element at the given data position
+            [[nodiscard]]
+            generation_type generation_at(size_type pos) const
+            {
+                if constexpr (colocated) {
+                    return m_indexes[m_metadata[pos].id()].generation();
+                } else {
+                    return m_metadata[pos].generation();
+                }
+            }
+
+            [[nodiscard]]
+            size_type index(id_type id) const
+            {
+                assert(id < m_indexes.size() && "ID out of range");
+                return position(id);
+            }
+
+            [[nodiscard]]
+            generation_type generation(id_type id) const
+            {
+                assert(id < m_indexes.size() && "ID out of range");
+                if constexpr (colocated) {
+                    return m_indexes[id].generation();
+                } else {
+                    assert(!is_detached(id) && "ID is reserved");
+                    return m_metadata[m_indexes[id]].generation();
+                }
+            }
+
+            /// Whether an ID + generation pair references one of the `size` live positions
+            [[nodiscard]]
+            bool is_valid(id_type id, generation_type generation, size_type size) const noexcept
+            {
+                return find(id, generation, size) != size;
+            }
+
+            /** Validates an ID + generation pair and returns its data position, or `size` if stale.
+             *  With a co-located layout this costs a single load from the index table.
+             */
+            [[nodiscard]]
+            size_type find(id_type id, generation_type generation, size_type size) const noexcept
+            {
+                if (id >= m_indexes.size()) {
+                    return size;
+                }
+                if constexpr (colocated) {
+                    const index_entry entry = m_indexes[id];
+                    return (generation == entry.generation() && entry.id() < size) ? entry.id() : size;
+                } else {
+                    const size_type pos = m_indexes[id];
+                    return (pos < size && generation == m_metadata[pos].generation()) ? pos : size;
+                }
+            }
+
+            /** Validates `n` ID + generation pairs at once: out[i] = is_valid(ids[i], generations[i], size).
+             *  With contiguous tables whose IDs and generations share a 4- or 8-byte width, the lookups
+             *  are AVX2 or AVX-512 gathers, as selected by `isa`; otherwise, and for the last pairs that
+             *  do not fill a register, a scalar loop.
+             *  @return The number of valid pairs
+             */
+            size_type validate(const id_type* ids, const generation_type* generations, size_type n, size_type size,
+                               bool* out, [[maybe_unused]] detail::simd_isa isa = detail::detected_simd_isa()) const noexcept
+            {
+                size_type valid{0};
+                size_type done{0};
+#if SIV_X86_SIMD
+                if constexpr (simd_layout) {
+                    using lane = id_type;
+                    const size_type index_count = m_indexes.size();
+                    // The 32-bit gathers take signed offsets, up to twice an ID or a position
+                    const bool fits = sizeof(lane) == 8
+                                   || std::max(index_count, size) <= size_type{std::numeric_limits<int>::max() / 2};
+                    const lane* positions   = reinterpret_cast<const lane*>(m_indexes.data());
+                    const lane* generations_of = colocated ? positions + 1
+                                                           : reinterpret_cast<const lane*>(m_metadata.data()) + 1;
+                    if (fits && isa == detail::simd_isa::avx512) {
+                        done  = n - n % (64 / sizeof(lane));
+                        valid = detail::validate_avx512<colocated>(ids, generations, done, positions, generations_of,
+                                                                   index_count, size, out);
+                    } else if (fits && isa == detail::simd_isa::avx2) {
+                        done  = n - n % (32 / sizeof(lane));
+                        valid = detail::validate_avx2<colocated>(ids, generations, done, positions, generations_of,
+                                                                 index_count, size, out);
+                    }
+                }
+#endif
+                for (size_type i = done; i < n; ++i) {
+                    out[i] = is_valid(ids[i], generations[i], size);
+                    valid += out[i] ? 1 : 0;
+                }
+                return valid;
+            }
+
+            /// Hints that the index entry of `id` is about to be read (ignored for out-of-range IDs)
+            void prefetch(id_type id) const noexcept
+            {
+                if (id < m_indexes.size()) {
+                    detail::prefetch(&m_indexes[id]);
+                }
+            }
+
+            [[nodiscard]]
+            bool contains(id_type id, size_type size) const noexcept
+            {
+                return id < m_indexes.size() && position(id) < size;
+            }
+
+            [[nodiscard]]
+            id_type next_id(size_type size) const
+            {
+                if constexpr (tracks_free) {
+                    if (free_count(size) > Traits::quarantine) {
+                        return m_free.top();
+                    }
+                } else {
+                    // Mirrors get_free_id(): each retired candidate is replaced by the last free entry
+                    size_type end = free_end();
+                    for (size_type pos = size; end - size > Traits::quarantine; pos = --end) {
+                        if (reusable(m_metadata[pos].id())) {
+                            return m_metadata[pos].id();
+                        }
+                    }
+                }
+                return static_cast<id_type>(m_indexes.size());
+            }
+
+            /// Number of IDs retired because their generation counter is exhausted
+            [[nodiscard]]
+            size_type retired_count() const noexcept
+            {
+                return m_retired;
+            }
+
+            // Raw tables, for readers that load them without synchronization and validate afterwards
+            // (see siv::optimistic_vector). Requires contiguous table storage.
+            [[nodiscard]] const index_entry* index_data()        const noexcept { return m_indexes.data();      }
+            [[nodiscard]] size_type          index_count()       const noexcept { return m_indexes.size();      }
+            [[nodiscard]] size_type          index_capacity()    const noexcept { return m_indexes.capacity();  }
+            [[nodiscard]] const metadata*    metadata_data()     const noexcept { return m_metadata.data();     }
+            [[nodiscard]] size_type          metadata_capacity() const noexcept { return m_metadata.capacity(); }
+
+            /// The position recorded in an index entry
+            [[nodiscard]]
+            static size_type entry_position(const index_entry& entry) noexcept
+            {
+                if constexpr (colocated) {
+                    return entry.id();
+                } else {
+                    return entry;
+                }
+            }
+
+        private:
+            [[nodiscard]]
+            size_type position(id_type id) const noexcept
+            {
+                if constexpr (colocated) {
+                    return m_indexes[id].id();
+                } else {
+                    return m_indexes[id];
+                }
+            }
+
+            void set_position(id_type id, size_type pos) noexcept
+            {
+                if constexpr (colocated) {
+                    m_indexes[id].set_id(static_cast<id_type>(pos));
+                } else {
+                    m_indexes[id] = static_cast<id_type>(pos);
+                }
+            }
+
+            /// A free ID can be recycled only if it can still be bumped on reuse and on erase
+            [[nodiscard]]
+            bool reusable(id_type id) const noexcept
+            {
+                if constexpr (Traits::generation_bits >= 64) {
+                    (void)id;
+                    return true;
+                } else {
+                    return generation(id) < max_generation - 1;
+                }
+            }
+
+            /// reusable() for the ID at `pos`, reading the generation without the index indirection
+            [[nodiscard]]
+            bool reusable_at(size_type pos) const noexcept
+            {
+                if constexpr (Traits::generation_bits >= 64) {
+                    (void)pos;
+                    return true;
+                } else {
+                    return generation_at(pos) < max_generation - 1;
+                }
+            }
+
+            /// bump_generation() for the ID at `pos`, without the index indirection
+            void bump_generation_at(size_type pos) noexcept
+            {
+                if constexpr (colocated) {
+                    bump_generation(m_metadata[pos].id());
+                } else {
+                    assert(m_metadata[pos].generation() < max_generation && "Generation overflow");
+                    m_metadata[pos].set_generation(static_cast<generation_type>(m_metadata[pos].generation() + 1));
+                }
+            }
+
+            void bump_generation(id_type id) noexcept
+            {
+                assert(generation(id) < max_generation && "Generation overflow");
+                const auto next = static_cast<generation_type>(generation(id) + 1);
+                if constexpr (colocated) {
+                    m_indexes[id].set_generation(next);
+                } else {
+                    m_metadata[m_indexes[id]].set_generation(next);
+                }
+            }
+
+            [[nodiscard]]
+            size_type free_end() const noexcept
+            {
+                return m_metadata.size() - m_retired;
+            }
+
+            /// Swaps the bookkeeping stored at two positions and patches their index entries
+            void swap_positions(size_type a, size_type b)
+            {
+                std::swap(m_metadata[a], m_metadata[b]);
+                set_position(m_metadata[a].id(), a);
+                set_position(m_metadata[b].id(), b);
+            }
+
+            /// Moves the free entry at `pos` into the retired tail
+            void retire(size_type pos)
+            {
+                swap_positions(pos, free_end() - 1);
+                ++m_retired;
+            }
+
+            /// Releases every position in [new_size, size), as release() does one at a time
+            void release_tail(size_type new_size, size_type size) noexcept
+            {
+                for (size_type pos = size; pos-- > new_size;) {
+                    bump_generation_at(pos);
+                    free_or_retire(pos);
+                }
+            }
+
+            /// Makes the entry just moved to the free position `pos` recyclable, or retires it
+            void free_or_retire(size_type pos)
+            {
+                if (!reusable_at(pos)) {
+                    retire(pos);
+                } else if constexpr (tracks_free) {
+                    m_free.push(m_metadata[pos].id());
+                }
+            }
+
+            /// Number of free IDs ready to be recycled
+            [[nodiscard]]
+            size_type free_count(size_type size) const noexcept
+            {
+                if constexpr (tracks_free) {
+                    (void)size;
+                    return m_free.size();
+                } else {
+                    return free_end() - size;
+                }
+            }
+
+            /// Queues every entry of the free region, after the queue was cleared.
+            /// On allocation failure the IDs are left out of the queue, and fresh IDs are created instead.
+            void queue_free_ids(size_type size)
+            {
+                m_free.prepare(free_end() - size);
+                for (size_type pos = size; pos < free_end(); ++pos) {
+                    m_free.push(m_metadata[pos].id());
+                }
+            }
+
+            static free_ids_type make_free_ids([[maybe_unused]] const Allocator& alloc)
+            {
+                if constexpr (tracks_free) {
+                    using storage = typename Traits::template table_storage<id_type, id_allocator_type>;
+                    return free_ids_type(storage(id_allocator_type(alloc)));
+                } else {
+                    return {};
+                }
+            }
+
+            id_type get_free_id(size_type size)
+            {
+                while (free_count(size) > Traits::quarantine) {
+                    if constexpr (tracks_free) {
+                        const id_type id = m_free.top();
+                        assert(reusable(id) && "Queued ID cannot be recycled");
+                        m_free.pop();
+                        if (position(id) != size) {
+                            swap_positions(position(id), size);
+                        }
+                        bump_generation(id);
+                        return id;
+                    } else {
+                        // IDs freed by release_all() were not checked for reuse: retire them lazily
+                        const id_type id = m_metadata[size].id();
+                        if (reusable(id)) {
+                            bump_generation(id);
+                            return id;
+                        }
+                        retire(size);
+                    }
+                }
+                const size_type new_id = m_indexes.size();
+                if (new_id >= invalid_id) {
+#if SIV_EXCEPTIONS
+                    throw std::length_error("siv::vector: ID space exhausted");
+#else
+                    assert(false && "siv::vector: ID space exhausted");
+#endif
+                }
+                // Reserve both before modifying either to prevent desync on allocation failure
+                detail::reserve_one_more(m_indexes);
+                detail::reserve_one_more(m_metadata);
+                // After successful reserves, push_back on trivial types cannot throw
+                const generation_type floor = m_floors.size() > 0 ? m_floors.back().floor : generation_type{0};
+                if constexpr (colocated) {
+                    m_indexes.push_back({detached_position, floor});
+                    link(metadata{static_cast<id_type>(new_id)});
+                } else {
+                    m_indexes.push_back(detached_position);
+                    link({static_cast<id_type>(new_id), floor});
+                }
+                if (m_floors.size() > 0 && m_floors.back().end == new_id + 1) {
+                    m_floors.pop_back();
+                }
+                if (free_end() - 1 != size) {
+                    // Free IDs held back by the quarantine stay behind the new live position
+                    swap_positions(size, free_end() - 1);
+                }
+                return static_cast<id_type>(new_id);
+            }
+
+            /// Appends the metadata entry of an ID to the free region, before the retired tail.
+            /// The metadata table must have room for it.
+            void link(const metadata& entry) noexcept
+            {
+                m_metadata.push_back(entry);
+                set_position(entry.id(), m_metadata.size() - 1);
+                if (m_retired > 0) {
+                    // Keep the retired tail contiguous: the new entry takes the first retired position
+                    swap_positions(free_end() - 1, m_metadata.size() - 1);
+                }
+            }
+
+            /// Position read from the index entry of a detached ID: past any live region
+            static constexpr id_type detached_position = invalid_id;
+
+            metadata_storage m_metadata;
+            index_storage    m_indexes;
+            size_type        m_retired  = 0;
+            size_type        m_detached = 0;
+            free_ids_type    m_free;
+            /// Starting generations of the IDs released by shrink(), lowest IDs at the back
+            floor_storage    m_floors;
+        };
+    }
+
+    /** A standalone smart reference to an object managed by a siv::vector.
+     *  Tracks validity via a generation counter to detect use-after-erase.
+     *
+     * @tparam T The type of the referenced object
+     * @tparam Allocator The allocator type used by the owning vector
+     * @tparam Traits The ID/generation width policy of the owning vector
+     */
+    template<typename T, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class handle
+    {
+    public:
+        using id_type         = typename Traits::id_type;
+        using generation_type = typename Traits::generation_type;
+        using key_type        = typename Traits::key_type;
+
+        handle() = default;
+
+        T* operator->()
+        {
+            assert(valid() && "Dereferencing invalid handle");
+            return &(*m_vector)[m_id];
+        }
+
+        const T* operator->() const
+        {
+            assert(valid() && "Dereferencing invalid handle");
+            return &(*m_vector)[m_id];
+        }
+
+        T& operator*()
+        {
+            assert(valid() && "Dereferencing invalid handle");
+            return (*m_vector)[m_id];
+        }
+
+        const T& operator*() const
+        {
+            assert(valid() && "Dereferencing invalid handle");
+            return (*m_vector)[m_id];
+        }
+
+        /// Returns a pointer to the referenced object, or nullptr if it was erased
+        [[nodiscard]]
+        T* get() const noexcept
+        {
+            return m_vector ? m_vector->find(m_id, m_generation) : nullptr;
+        }
+
+        [[nodiscard]]
+        id_type id() const noexcept
+        {
+            return m_id;
+        }
+
+        [[nodiscard]]
+        generation_type generation() const noexcept
+        {
+            return m_generation;
+        }
+
+        /// Returns the ID and generation packed in one word (only for traits with a key_type)
+        [[nodiscard]]
+        key_type key() const noexcept
+        {
+            return vector<T, Allocator, Traits>::make_key(m_id, m_generation);
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return valid();
+        }
+
+        [[nodiscard]]
+        bool valid() const noexcept
+        {
+            return m_vector && m_vector->is_valid(m_id, m_generation);
+        }
+
+    private:
+        handle(id_type id, generation_type generation, vector<T, Allocator, Traits>* vec)
+            : m_id{id}
+            , m_generation{generation}
+            , m_vector{vec}
+        {}
+
+        id_type                         m_id         = 0;
+        generation_type                 m_generation = 0;
+        vector<T, Allocator, Traits>*   m_vector     = nullptr;
+
+        friend class vector<T, Allocator, Traits>;
+    };
+
+    /** A vector providing stable IDs for element access.
+     *  IDs remain valid across insertions and deletions of other elements.
+     *  Data is stored contiguously for cache-friendly iteration (or page by page with
+     *  siv::paged_traits, which keeps element addresses stable across growth).
+     *
+     * @tparam T The element type. Must be move-constructible and move-assignable.
+     * @tparam Allocator The allocator type. Defaults to std::allocator<T>.
+     * @tparam Traits The ID/generation width policy. Defaults to 64-bit IDs and generations.
+     */
+    template<typename T, typename Allocator, typename Traits>
+    class vector
+    {
+        using id_table_type = detail::id_table<Traits, Allocator>;
+        using storage_type  = typename Traits::template storage<T, Allocator>;
+
+        static constexpr bool is_paged       = detail::is_paged_storage<storage_type>::value;
+        static constexpr bool has_tombstones = Traits::erase_mode == erase_policy::tombstone;
+        static constexpr bool has_observer   = !std::is_same_v<typename Traits::observer, no_observer>;
+        static constexpr bool relocates      = detail::relocates<storage_type>::value;
+
+        using flags_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<bool>;
+        using flags_type           = std::conditional_t<has_tombstones,
+                                                        typename Traits::template table_storage<bool, flags_allocator_type>,
+                                                        detail::empty_member>;
+
+        template<typename Base>
+        using live_iterator = detail::live_iterator<Base, flags_type>;
+
+        /// Temporary buffer of the batch operations, drawing from the vector's allocator
+        template<typename U>
+        using scratch_type = std::vector<U, typename std::allocator_traits<Allocator>::template rebind_alloc<U>>;
+
+    public:
+        // -- Member types (std::vector compatible) --
+
+        using value_type             = T;
+        using allocator_type         = Allocator;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using reference              = T&;
+        using const_reference        = const T&;
+        using pointer                = T*;
+        using const_pointer          = const T*;
+        using iterator               = std::conditional_t<has_tombstones,
+                                                          live_iterator<typename storage_type::iterator>,
+                                                          typename storage_type::iterator>;
+        using const_iterator         = std::conditional_t<has_tombstones,
+                                                          live_iterator<typename storage_type::const_iterator>,
+                                                          typename storage_type::const_iterator>;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        // -- Stable-ID types --
+
+        using traits_type     = Traits;
+        using id_type         = typename Traits::id_type;
+        using generation_type = typename Traits::generation_type;
+        using key_type        = typename Traits::key_type;
+        using handle_type     = handle<T, Allocator, Traits>;
+        using observer_type   = typename Traits::observer;
+        using reservation_type = id_reservation<T, Allocator, Traits>;
+
+        /// All-ones ID of the configured width, never assigned to an element
+        static constexpr id_type invalid_id = id_table_type::invalid_id;
+
+        // -- Constructors / assignment --
+
+        vector() = default;
+
+        explicit vector(const Allocator& alloc)
+            : m_data(alloc)
+            , m_ids(alloc)
+            , m_dead(make_flags(alloc))
+        {}
+
+        /// Non-copyable and non-movable to prevent dangling handle pointers
+        vector(const vector&) = delete;
+        vector& operator=(const vector&) = delete;
+        vector(vector&&) = delete;
+        vector& operator=(vector&&) = delete;
+
+        // -- Element access --
+
+        /** Bounds-checked access by ID.
+         *  @throws std::out_of_range if exceptions are enabled, otherwise asserts
+         */
+        reference at(id_type id)
+        {
+            check_at(id);
+            return m_data[m_ids.index(id)];
+        }
+
+        const_reference at(id_type id) const
+        {
+            check_at(id);
+            return m_data[m_ids.index(id)];
+        }
+
+        /// Access element by stable ID (no bounds checking)
+        reference operator[](id_type id)
+        {
+            return m_data[m_ids.index(id)];
+        }
+
+        const_reference operator[](id_type id) const
+        {
+            return m_data[m_ids.index(id)];
+        }
+
+        reference front()
+        {
+            assert(!empty() && "front on empty vector");
+            return *begin();
+        }
+
+        const_reference front() const
+        {
+            assert(!empty() && "front on empty vector");
+            return *begin();
+        }
+
+        reference back()
+        {
+            assert(!empty() && "back on empty vector");
+            return *std::prev(end());
+        }
+
+        const_reference back() const
+        {
+            assert(!empty() && "back on empty vector");
+            return *std::prev(end());
+        }
+
+        /// Pointer to the contiguous storage (unavailable with paged storage, see page()).
+        /// With erase_policy::tombstone, the storage also holds the dead slots (see is_live_at()).
+        template<typename S = storage_type, typename = std::enable_if_t<!detail::is_paged_storage<S>::value>>
+        pointer data() noexcept
+        {
+            return m_data.data();
+        }
+
+        template<typename S = storage_type, typename = std::enable_if_t<!detail::is_paged_storage<S>::value>>
+        const_pointer data() const noexcept
+        {
+            return m_data.data();
+        }
+
+        /// Number of contiguous runs holding the elements: one for contiguous storage (if non-empty)
+        [[nodiscard]]
+        size_type page_count() const noexcept
+        {
+            if constexpr (is_paged) {
+                return m_data.page_count();
+            } else {
+                return m_data.empty() ? 0 : 1;
+            }
+        }
+
+        /// Contiguous run `i` of elements in data order
+        [[nodiscard]]
+        span<T> page(size_type i) noexcept
+        {
+            if constexpr (is_paged) {
+                return m_data.page(i);
+            } else {
+                assert(i < page_count() && "Page index out of range");
+                return {m_data.data(), m_data.size()};
+            }
+        }
+
+        [[nodiscard]]
+        span<const T> page(size_type i) const noexcept
+        {
+            if constexpr (is_paged) {
+                return m_data.page(i);
+            } else {
+                assert(i < page_count() && "Page index out of range");
+                return {m_data.data(), m_data.size()};
+            }
+        }
+
+        /** Batch operator[]: out[i] = &(*this)[ids[i]], for every i.
+         *  The index entries and then the elements are prefetched a few IDs ahead, so that the cache
+         *  misses of consecutive lookups overlap instead of being paid one after the other.
+         */
+        void gather(span<const id_type> ids, span<pointer> out)
+        {
+            assert(out.size() >= ids.size() && "Output span too small");
+            resolve(ids, [this, out](size_type i, size_type pos) { out[i] = &m_data[pos]; });
+        }
+
+        void gather(span<const id_type> ids, span<const_pointer> out) const
+        {
+            assert(out.size() >= ids.size() && "Output span too small");
+            resolve(ids, [this, out](size_type i, size_type pos) { out[i] = &m_data[pos]; });
+        }
+
+        /// Batch copy: out[i] = (*this)[ids[i]], for every i, with the prefetching of gather()
+        void gather_values(span<const id_type> ids, span<T> out) const
+        {
+            assert(out.size() >= ids.size() && "Output span too small");
+            resolve(ids, [this, out](size_type i, size_type pos) { out[i] = m_data[pos]; });
+        }
+
+        // -- Iterators --
+
+        iterator       begin()        noexcept { return make_iterator<iterator>(m_data, 0);             }
+        iterator       end()          noexcept { return make_iterator<iterator>(m_data, m_data.size()); }
+        const_iterator begin()  const noexcept { return make_iterator<const_iterator>(m_data, 0);             }
+        const_iterator end()    const noexcept { return make_iterator<const_iterator>(m_data, m_data.size()); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend()   const noexcept { return end();   }
+
+        reverse_iterator       rbegin()        noexcept { return reverse_iterator(end());         }
+        reverse_iterator       rend()          noexcept { return reverse_iterator(begin());       }
+        const_reverse_iterator rbegin()  const noexcept { return const_reverse_iterator(end());   }
+        const_reverse_iterator rend()    const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin();                        }
+        const_reverse_iterator crend()   const noexcept { return rend();                          }
+
+        // -- Capacity --
+
+        [[nodiscard]] bool      empty()    const noexcept { return size() == 0;                }
+        [[nodiscard]] size_type size()     const noexcept { return m_data.size() - m_holes;   }
+        [[nodiscard]] size_type max_size() const noexcept { return m_data.max_size();         }
+        [[nodiscard]] size_type capacity() const noexcept { return m_data.capacity();         }
+
+        void reserve(size_type new_cap)
+        {
+            m_data.reserve(new_cap);
+            m_ids.reserve(new_cap);
+            if constexpr (has_tombstones) {
+                m_dead.reserve(new_cap);
+            }
+        }
+
+        // -- Tombstones (erase_policy::tombstone) --
+
+        /// Number of storage slots, live or dead. Equals size() with erase_policy::swap_and_pop.
+        [[nodiscard]]
+        size_type slot_count() const noexcept
+        {
+            return m_data.size();
+        }
+
+        /// Number of dead slots waiting for compact()
+        [[nodiscard]]
+        size_type hole_count() const noexcept
+        {
+            return m_holes;
+        }
+
+        /// Whether the slot at the given data index holds a live element
+        [[nodiscard]]
+        bool is_live_at(size_type idx) const noexcept
+        {
+            assert(idx < m_data.size() && "Index out of range");
+            if constexpr (has_tombstones) {
+                return !m_dead[idx];
+            } else {
+                return true;
+            }
+        }
+
+        /** Removes every hole in one linear pass, preserving the order of the survivors.
+         *  Dead elements are destroyed and their IDs become recyclable. Data indexes of the
+         *  survivors change; IDs and handles stay valid. No-op with erase_policy::swap_and_pop.
+         */
+        void compact()
+        {
+            if constexpr (has_tombstones) {
+                if (m_holes == 0) {
+                    return;
+                }
+                const size_type slots = m_data.size();
+                size_type write = 0;
+                if constexpr (relocates) {
+                    write = m_data.compact([this](size_type pos) { return bool(m_dead[pos]); },
+                                           [this](size_type from, size_type to) { notify_relocate(from, to); });
+                } else {
+                    for (size_type pos{0}; pos < slots; ++pos) {
+                        if (!m_dead[pos]) {
+                            if (write != pos) {
+                                notify_relocate(pos, write);
+                                m_data[write] = std::move(m_data[pos]);
+                            }
+                            ++write;
+                        }
+                    }
+                }
+                m_ids.compact(slots, [this](size_type pos) { return bool(m_dead[pos]); });
+                while (m_data.size() > write) {
+                    m_data.pop_back();
+                }
+                for (size_type pos{0}; pos < write; ++pos) {
+                    m_dead[pos] = false;
+                }
+                while (m_dead.size() > write) {
+                    m_dead.pop_back();
+                }
+                m_holes = 0;
+            }
+        }
+
+        /// Hole ratio above which erase() compacts automatically (erase_policy::tombstone only)
+        [[nodiscard]]
+        double max_hole_ratio() const noexcept
+        {
+            return m_max_hole_ratio;
+        }
+
+        /// Sets the automatic compaction threshold; 1.0 or more disables automatic compaction
+        void set_max_hole_ratio(double ratio) noexcept
+        {
+            m_max_hole_ratio = ratio;
+        }
+
+        /** Shrinks the data vector and releases the free IDs above the highest live ID, so that the
+         *  index and metadata tables shrink too. Live IDs and handles stay valid; stale handles
+         *  stay invalid. With erase_policy::tombstone, compact() runs first.
+         */
+        void shrink_to_fit()
+        {
+            compact();
+            m_data.shrink_to_fit();
+            m_ids.shrink(m_data.size());
+            if constexpr (has_tombstones) {
+                m_dead.shrink_to_fit();
+            }
+        }
+
+        /// Returns a copy of the allocator
+        [[nodiscard]]
+        allocator_type get_allocator() const noexcept
+        {
+            return m_data.get_allocator();
+        }
+
+        /// The observer notified of insertions, erasures and relocations (see siv::observing_traits)
+        observer_type& observer() noexcept
+        {
+            return m_observer;
+        }
+
+        const observer_type& observer() const noexcept
+        {
+            return m_observer;
+        }
+
+        // -- Modifiers --
+
+        /// Removes all elements and invalidates all existing handles
+        void clear()
+        {
+            if constexpr (has_observer) {
+                visit(*this, 0, m_data.size(), [this](size_type pos, const T&) { notify_erase(pos); });
+            }
+            m_ids.release_all(m_data.size());
+            m_data.clear();
+            if constexpr (has_tombstones) {
+                m_dead.clear();
+                m_holes = 0;
+            }
+        }
+
+        /** Copies the provided object at the end of the vector
+         *  @return The stable ID to retrieve the object
+         */
+        [[nodiscard]]
+        id_type push_back(const T& value)
+        {
+            const id_type id = get_free_slot();
+            construct_slot([&] { m_data.push_back(value); });
+            notify_insert(m_data.size() - 1);
+            return id;
+        }
+
+        /** Moves the provided object at the end of the vector
+         *  @return The stable ID to retrieve the object
+         */
+        [[nodiscard]]
+        id_type push_back(T&& value)
+        {
+            const id_type id = get_free_slot();
+            construct_slot([&] { m_data.push_back(std::move(value)); });
+            notify_insert(m_data.size() - 1);
+            return id;
+        }
+
+        /** Constructs an element in-place at the end of the vector
+         *  @return The stable ID to retrieve the object
+         */
+        template<typename... Args>
+        [[nodiscard]]
+        id_type emplace_back(Args&&... args)
+        {
+            const id_type id = get_free_slot();
+            construct_slot([&] { m_data.emplace_back(std::forward<Args>(args)...); });
+            notify_insert(m_data.size() - 1);
+            return id;
+        }
+
+        /** Appends `n` elements constructed from `args`, or value-initialized without arguments
+         *  (default-initialized with siv::default_init_allocator). Reserves once, then hands out
+         *  recycled IDs first and fresh ones after.
+         *  @param out Receives the n stable IDs in data order; may be empty if the IDs are not needed
+         */
+        template<typename... Args>
+        void emplace_n(size_type n, span<id_type> out, const Args&... args)
+        {
+            append_n(n, out, [&] {
+                if constexpr (sizeof...(Args) == 0 && detail::has_resize<storage_type>::value) {
+                    m_data.resize(m_data.size() + n);
+                } else {
+                    append_or_rollback([&] {
+                        for (size_type i{0}; i < n; ++i) {
+                            m_data.emplace_back(args...);
+                        }
+                    });
+                }
+            });
+        }
+
+        /** Appends a copy of every element of [first, last) with a single reservation
+         *  @param out Receives the stable IDs in data order; may be empty if the IDs are not needed
+         */
+        template<typename ForwardIt>
+        void insert_range(ForwardIt first, ForwardIt last, span<id_type> out)
+        {
+            static_assert(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>,
+                          "insert_range requires forward iterators");
+            const auto n = static_cast<size_type>(std::distance(first, last));
+            append_n(n, out, [&] {
+                append_or_rollback([&] {
+                    for (auto it = first; it != last; ++it) {
+                        m_data.emplace_back(*it);
+                    }
+                });
+            });
+        }
+
+        template<typename Range>
+        void insert_range(const Range& range, span<id_type> out)
+        {
+            insert_range(std::begin(range), std::end(range), out);
+        }
+
+        /** Grows to `n` elements with emplace_n(), or erases the last elements in data order
+         *  @param out Receives the IDs of the added elements; may be empty
+         */
+        void resize(size_type n, span<id_type> out = {})
+        {
+            if (n > size()) {
+                emplace_n(n - size(), out);
+            }
+            while (size() > n) {
+                pop_back();
+            }
+        }
+
+        /// Removes the last element in data order
+        void pop_back()
+        {
+            assert(!empty() && "pop_back on empty vector");
+            if constexpr (has_tombstones) {
+                erase_at(std::prev(end()).position());
+            } else {
+                erase_at(m_data.size() - 1);
+            }
+        }
+
+        /** Removes the object referenced by the provided stable ID.
+         *  With erase_policy::tombstone the slot is only marked dead, and compact() may run.
+         *  @param id The stable ID of the object to remove
+         */
+        void erase(id_type id)
+        {
+            if constexpr (has_tombstones) {
+                kill(id);
+                compact_if_needed();
+            } else {
+                if constexpr (has_observer) {
+                    assert(contains(id) && "Object already erased or ID invalid");
+                    const size_type data_idx = m_ids.index(id);
+                    notify_erase(data_idx);
+                    if (data_idx != m_data.size() - 1) {
+                        notify_relocate(m_data.size() - 1, data_idx);
+                    }
+                }
+                const size_type data_idx = m_ids.release(id, m_data.size());
+                if constexpr (relocates) {
+                    m_data.swap_and_pop(data_idx);
+                } else {
+                    std::swap(m_data[data_idx], m_data.back());
+                    m_data.pop_back();
+                }
+            }
+        }
+
+        /** Removes the object referenced by the handle
+         *  @param h A handle to the object to remove
+         */
+        void erase(const handle_type& h)
+        {
+            assert(h.m_vector == this && "Handle does not belong to this vector");
+            assert(h.valid() && "Handle references an erased object");
+            erase(h.id());
+        }
+
+        /** Removes the object at the given data index
+         *  @param idx Position in the contiguous data array
+         */
+        void erase_at(size_type idx)
+        {
+            assert(idx < m_data.size() && "Index out of range");
+            erase(m_ids.rid(idx));
+        }
+
+        /** Removes all elements matching the predicate (C++20-style member)
+         *  @param predicate Unary predicate returning true for elements to remove
+         */
+        template<typename Pred>
+        void erase_if(Pred&& predicate)
+        {
+            if constexpr (has_tombstones) {
+                for (size_type i{0}; i < m_data.size(); ++i) {
+                    if (!m_dead[i] && predicate(m_data[i])) {
+                        kill(m_ids.rid(i));
+                    }
+                }
+                compact_if_needed();
+            } else if constexpr (has_observer) {
+                // Evaluate the predicate everywhere first, so that the observer never hears of an
+                // erasure that a throwing predicate cancels
+                scratch_type<unsigned char> dead(m_data.size(), 0, scratch_allocator<unsigned char>());
+                for (size_type i{0}; i < m_data.size(); ++i) {
+                    dead[i] = predicate(m_data[i]) ? 1 : 0;
+                }
+                erase_flagged(dead, false);
+            } else {
+                m_ids.release_where(m_data.size(),
+                                    [&](size_type i) -> bool { return predicate(m_data[i]); },
+                                    [this](size_type hole, size_type src) { move_slot(hole, src); },
+                                    [this](size_type new_size) { truncate(new_size); });
+            }
+        }
+
+        /** Parallel erase_if(): the predicate runs over chunks of the data concurrently and its results
+         *  are recorded, then each chunk of the surviving range fills its holes from the end concurrently.
+         *  `predicate` is called from several threads at once; if it throws, nothing is erased.
+         *  Below two chunks (see detail::parallel_grain), a noexcept predicate goes through the
+         *  sequential erase_if(), which needs no record since nothing can throw midway.
+         */
+        template<typename Pred>
+        void erase_if(execution::parallel_policy, Pred&& predicate)
+        {
+            const size_type n = m_data.size();
+            if constexpr (std::is_nothrow_invocable_v<Pred&, T&>) {
+                if (detail::parallel_chunks(n) <= 1) {
+                    erase_if(predicate);
+                    return;
+                }
+            }
+            scratch_type<unsigned char> dead(n, 0, scratch_allocator<unsigned char>());
+            detail::parallel_for(n, [&](size_type begin, size_type end) {
+                visit(*this, begin, end, [&](size_type pos, T& value) {
+                    dead[pos] = predicate(value) ? 1 : 0;
+                });
+            });
+            if constexpr (has_tombstones) {
+                for (size_type i{0}; i < n; ++i) {
+                    if (dead[i]) {
+                        kill(m_ids.rid(i));
+                    }
+                }
+                compact_if_needed();
+            } else {
+                erase_flagged(dead, true);
+            }
+        }
+
+        /** Removes every object referenced by the given IDs (unsorted, no duplicates) in one pass.
+         *  Only the survivors that fill the holes are moved. Same generation semantics as erase(id).
+         */
+        void erase(span<const id_type> ids)
+        {
+            if constexpr (has_tombstones) {
+                for (const id_type id : ids) {
+                    kill(id);
+                }
+                compact_if_needed();
+            } else {
+                scratch_type<size_type> dead(scratch_allocator<size_type>());
+                dead.reserve(ids.size());
+                for (const id_type id : ids) {
+                    assert(contains(id) && "Object already erased or ID invalid");
+                    dead.push_back(m_ids.index(id));
+                }
+                std::sort(dead.begin(), dead.end());
+                assert(std::adjacent_find(dead.begin(), dead.end()) == dead.end() && "Duplicate ID");
+                if constexpr (has_observer) {
+                    for (const size_type pos : dead) {
+                        notify_erase(pos);
+                    }
+                }
+                m_ids.release_positions(dead.data(), dead.size(), m_data.size(),
+                                        [this](size_type hole, size_type src) { move_slot(hole, src); },
+                                        [this](size_type new_size) { truncate(new_size); });
+            }
+        }
+
+        /// Removes every object referenced by the given handles (see erase(span<const id_type>))
+        void erase(span<const handle_type> handles)
+        {
+            scratch_type<id_type> ids(scratch_allocator<id_type>());
+            ids.reserve(handles.size());
+            for (const handle_type& h : handles) {
+                assert(h.m_vector == this && "Handle does not belong to this vector");
+                assert(h.valid() && "Handle references an erased object");
+                ids.push_back(h.id());
+            }
+            erase(span<const id_type>(ids));
+        }
+
+        // -- ID reservation --
+
+        /** Reserves `n` IDs, recycled ones first, for objects constructed later by emplace_reserved().
+         *  A reserved ID reads as dead and is handed out by no insertion. Any thread can claim IDs
+         *  from the returned block, lock-free, and reference them right away (see siv::id_reservation).
+         *  While IDs are reserved, shrink_to_fit() keeps the ID tables.
+         */
+        [[nodiscard]]
+        reservation_type reserve_ids(size_type n)
+        {
+            return reservation_type(*this, n);
+        }
+
+        /** Constructs the object of an ID claimed from `reservation`, at the end of the data order.
+         *  Called from the thread owning the vector, once per claimed ID; the ID then becomes live.
+         */
+        template<typename... Args>
+        void emplace_reserved(reservation_type& reservation, id_type id, Args&&... args)
+        {
+            assert(reservation.m_vector == this && "Reservation does not belong to this vector");
+            assert(m_ids.is_detached(id) && "ID not reserved, already constructed or released");
+            m_ids.prepare_attach(1);
+            if constexpr (has_tombstones) {
+                detail::reserve_one_more(m_dead);
+            }
+            m_data.emplace_back(std::forward<Args>(args)...);
+            m_ids.attach(id, reservation.take(id), m_data.size() - 1, true);
+            commit_slot();
+            notify_insert(m_data.size() - 1);
+        }
+
+        /** Returns the IDs of `reservation` whose object was never constructed to the free IDs, and
+         *  empties the reservation. The reservation destructor calls it.
+         */
+        void release_ids(reservation_type& reservation)
+        {
+            assert(reservation.m_vector == this && "Reservation does not belong to this vector");
+            const size_type count = reservation.m_ids.size();
+            size_type unused{0};
+            for (size_type i{0}; i < count; ++i) {
+                unused += reservation.m_taken[i] ? 0 : 1;
+            }
+            m_ids.prepare_attach(unused);
+            for (size_type i{0}; i < count; ++i) {
+                if (!reservation.m_taken[i]) {
+                    m_ids.attach(reservation.m_ids[i], reservation.m_generations[i], m_data.size(), false);
+                }
+            }
+            reservation.m_ids.clear();
+            reservation.m_generations.clear();
+            reservation.m_taken.clear();
+            reservation.m_next.store(0, std::memory_order_relaxed);
+        }
+
+        // -- Reordering --
+
+        /** Sorts the elements in data order. IDs and handles keep referring to the same objects,
+         *  only data indexes change. Elements are moved once along the permutation cycles; the
+         *  metadata and index tables are rebuilt in a single pass.
+         *  With erase_policy::tombstone, compact() runs first.
+         *  @param comp Strict weak ordering on elements
+         */
+        template<typename Compare = std::less<>,
+                 typename = std::enable_if_t<!std::is_same_v<Compare, execution::parallel_policy>>>
+        void sort(Compare comp = {})
+        {
+            sort_impl<false, false>(comp);
+        }
+
+        /// Parallel sort: sorts chunks concurrently and merges them, then permutes in parallel.
+        /// `comp` is called from several threads at once.
+        template<typename Compare = std::less<>>
+        void sort(execution::parallel_policy, Compare comp = {})
+        {
+            sort_impl<false, true>(comp);
+        }
+
+        /// Same as sort(), but equivalent elements keep their relative data order
+        template<typename Compare = std::less<>,
+                 typename = std::enable_if_t<!std::is_same_v<Compare, execution::parallel_policy>>>
+        void stable_sort(Compare comp = {})
+        {
+            sort_impl<true, false>(comp);
+        }
+
+        template<typename Compare = std::less<>>
+        void stable_sort(execution::parallel_policy, Compare comp = {})
+        {
+            sort_impl<true, true>(comp);
+        }
+
+        /** Moves the element at data index perm[i] to data index i, for every i.
+         *  IDs and handles keep referring to the same objects.
+         *  With erase_policy::tombstone, the holes named by `perm` are dropped and compacted away:
+         *  the live elements end up at [0, size()), in the order `perm` gives them.
+         *  @param perm A permutation of the data indexes [0, slot_count())
+         */
+        void apply_permutation(span<const size_type> perm)
+        {
+            scratch_type<size_type> order = compacted_order(perm);
+            permute<false>(order);
+        }
+
+        /// Parallel apply_permutation(): gathers the elements into a scratch buffer, chunk by chunk
+        void apply_permutation(execution::parallel_policy, span<const size_type> perm)
+        {
+            scratch_type<size_type> order = compacted_order(perm);
+            permute<true>(order);
+        }
+
+        // -- Bulk algorithms --
+
+        /** Calls fn(element) for every element in data order, or fn(id, element) if fn takes the
+         *  stable ID first. fn must not insert or erase elements.
+         */
+        template<typename Fn,
+                 typename = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, execution::parallel_policy>>>
+        void for_each(Fn&& fn)
+        {
+            visit(*this, 0, m_data.size(), [&](size_type pos, T& value) { invoke_element(fn, pos, value); });
+        }
+
+        template<typename Fn,
+                 typename = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, execution::parallel_policy>>>
+        void for_each(Fn&& fn) const
+        {
+            visit(*this, 0, m_data.size(), [&](size_type pos, const T& value) { invoke_element(fn, pos, value); });
+        }
+
+        /// Parallel for_each(): each thread visits a contiguous chunk. `fn` is called from several threads at once.
+        template<typename Fn>
+        void for_each(execution::parallel_policy, Fn&& fn)
+        {
+            detail::parallel_for(m_data.size(), [&](size_type begin, size_type end) {
+                visit(*this, begin, end, [&](size_type pos, T& value) { invoke_element(fn, pos, value); });
+            });
+        }
+
+        template<typename Fn>
+        void for_each(execution::parallel_policy, Fn&& fn) const
+        {
+            detail::parallel_for(m_data.size(), [&](size_type begin, size_type end) {
+                visit(*this, begin, end, [&](size_type pos, const T& value) { invoke_element(fn, pos, value); });
+            });
+        }
+
+        /** Calls fn(element), or fn(id, element), for the element referenced by each ID, in the order of
+         *  `ids`, with the prefetching of gather(). fn must not insert or erase elements.
+         */
+        template<typename Fn>
+        void for_each(span<const id_type> ids, Fn&& fn)
+        {
+            resolve(ids, [&](size_type, size_type pos) { invoke_element(fn, pos, m_data[pos]); });
+        }
+
+        template<typename Fn>
+        void for_each(span<const id_type> ids, Fn&& fn) const
+        {
+            resolve(ids, [&](size_type, size_type pos) { invoke_element(fn, pos, m_data[pos]); });
+        }
+
+        /** Folds transform(element), or transform(id, element), into `init` with `reduce`, in data order.
+         *  @return reduce(...reduce(reduce(init, transform(e0)), transform(e1))..., transform(en))
+         */
+        template<typename R, typename Reduce, typename Transform>
+        [[nodiscard]]
+        R transform_reduce(R init, Reduce reduce, Transform transform) const
+        {
+            visit(*this, 0, m_data.size(), [&](size_type pos, const T& value) {
+                init = reduce(std::move(init), invoke_element(transform, pos, value));
+            });
+            return init;
+        }
+
+        /** Parallel transform_reduce(): each thread folds a chunk on its own, then the partial results are
+         *  folded into `init` in chunk order. `reduce` must be associative and commutative, as for
+         *  std::transform_reduce; both functions are called from several threads at once.
+         */
+        template<typename R, typename Reduce, typename Transform>
+        [[nodiscard]]
+        R transform_reduce(execution::parallel_policy, R init, Reduce reduce, Transform transform) const
+        {
+            const size_type n = m_data.size();
+            const std::size_t chunks = detail::parallel_chunks(n);
+            if (chunks <= 1) {
+                return transform_reduce(std::move(init), reduce, transform);
+            }
+            scratch_type<std::optional<R>> partials(chunks, scratch_allocator<std::optional<R>>());
+            detail::parallel_tasks(chunks, [&](std::size_t c) {
+                size_type begin = static_cast<size_type>(c * n / chunks);
+                const size_type end = static_cast<size_type>((c + 1) * n / chunks);
+                if constexpr (has_tombstones) {
+                    while (begin < end && m_dead[begin]) {
+                        ++begin;
+                    }
+                }
+                if (begin == end) {
+                    return;
+                }
+                R partial = invoke_element(transform, begin, m_data[begin]);
+                visit(*this, begin + 1, end, [&](size_type pos, const T& value) {
+                    partial = reduce(std::move(partial), invoke_element(transform, pos, value));
+                });
+                partials[c].emplace(std::move(partial));
+            });
+            for (auto& partial : partials) {
+                if (partial) {
+                    init = reduce(std::move(init), std::move(*partial));
+                }
+            }
+            return init;
+        }
+
+        // -- Stable-ID specific operations --
+
+        /** Returns the current data index for the given ID
+         *  @param id The stable ID
+         */
+        [[nodiscard]]
+        size_type index_of(id_type id) const
+        {
+            return m_ids.index(id);
+        }
+
+        /** Creates a handle pointing to the given stable ID
+         *  @param id The stable ID of a live object
+         */
+        handle_type make_handle(id_type id)
+        {
+            assert(contains(id));
+            return {id, m_ids.generation(id), this};
+        }
+
+        /** Creates a handle from a data index
+         *  @param idx Position in the contiguous data array
+         */
+        handle_type make_handle_at(size_type idx)
+        {
+            assert(idx < m_data.size() && is_live_at(idx));
+            return {m_ids.rid(idx), m_ids.generation_at(idx), this};
+        }
+
+        /** Validates handles in bulk: out[i] tells whether handles[i] references a live object of this
+         *  vector, i.e. handles[i].valid() for the handles made by this vector. The generations are
+         *  gathered from the ID table with AVX2 or AVX-512 when the CPU and the traits allow it
+         *  (see detail::id_table::validate()), without a branch per handle.
+         *  @return The number of valid handles
+         */
+        size_type validate(span<const handle_type> handles, span<bool> out) const noexcept
+        {
+            assert(out.size() >= handles.size() && "Output span too small");
+            constexpr size_type block = 256;
+            id_type         ids[block];
+            generation_type generations[block];
+            size_type valid{0};
+            for (size_type first{0}; first < handles.size(); first += block) {
+                const size_type n = std::min(block, handles.size() - first);
+                for (size_type i{0}; i < n; ++i) {
+                    const handle_type& h = handles[first + i];
+                    ids[i]         = h.m_vector == this ? h.m_id : id_table_type::invalid_id;
+                    generations[i] = h.m_generation;
+                }
+                valid += m_ids.validate(ids, generations, n, m_data.size(), out.data() + first);
+            }
+            return valid;
+        }
+
+        /** Checks if an ID + generation pair still references a live object.
+         *  Used internally by handle::valid().
+         */
+        [[nodiscard]]
+        bool is_valid(id_type id, generation_type generation) const noexcept
+        {
+            return m_ids.is_valid(id, generation, m_data.size());
+        }
+
+        /** Returns a pointer to the object referenced by an ID + generation pair, or nullptr if stale.
+         *  Validates and resolves with one index lookup when Traits::colocated_generation is set.
+         */
+        [[nodiscard]]
+        pointer find(id_type id, generation_type generation) noexcept
+        {
+            const size_type pos = m_ids.find(id, generation, m_data.size());
+            return (pos < m_data.size() && is_live_at(pos)) ? &m_data[pos] : nullptr;
+        }
+
+        [[nodiscard]]
+        const_pointer find(id_type id, generation_type generation) const noexcept
+        {
+            const size_type pos = m_ids.find(id, generation, m_data.size());
+            return (pos < m_data.size() && is_live_at(pos)) ? &m_data[pos] : nullptr;
+        }
+
+        /// Checks if a packed key still references a live object
+        [[nodiscard]]
+        bool is_valid(key_type key) const noexcept
+        {
+            return m_ids.is_valid(key_id(key), key_generation(key), m_data.size());
+        }
+
+        /// Returns the generation counter for the given ID
+        [[nodiscard]]
+        generation_type generation(id_type id) const
+        {
+            return m_ids.generation(id);
+        }
+
+        /// Packs the ID of a live object with its current generation into a single key
+        [[nodiscard]]
+        key_type make_key(id_type id) const
+        {
+            assert(contains(id));
+            return make_key(id, m_ids.generation(id));
+        }
+
+        [[nodiscard]]
+        static key_type make_key(id_type id, generation_type generation) noexcept
+        {
+            static_assert(has_key, "Traits::id_bits + Traits::generation_bits must fit in 64 bits");
+            if constexpr (has_key) {
+                return static_cast<key_type>(id | (static_cast<key_type>(generation) << Traits::id_bits));
+            } else {
+                return {};
+            }
+        }
+
+        [[nodiscard]]
+        static id_type key_id(key_type key) noexcept
+        {
+            static_assert(has_key, "Traits::id_bits + Traits::generation_bits must fit in 64 bits");
+            if constexpr (has_key) {
+                return static_cast<id_type>(key & detail::low_mask<Traits::id_bits>);
+            } else {
+                return {};
+            }
+        }
+
+        [[nodiscard]]
+        static generation_type key_generation(key_type key) noexcept
+        {
+            static_assert(has_key, "Traits::id_bits + Traits::generation_bits must fit in 64 bits");
+            if constexpr (has_key) {
+                return static_cast<generation_type>(key >> Traits::id_bits);
+            } else {
+                return {};
+            }
+        }
+
+        /// Number of IDs permanently retired after exhausting their generation counter
+        [[nodiscard]]
+        size_type retired_count() const noexcept
+        {
+            return m_ids.retired_count();
+        }
+
+        /// Returns the ID that would be assigned to the next inserted element
+        [[nodiscard]]
+        id_type next_id() const
+        {
+            return m_ids.next_id(m_data.size());
+        }
+
+        /// Checks whether the ID references a currently live object
+        [[nodiscard]]
+        bool contains(id_type id) const noexcept
+        {
+            return m_ids.contains(id, m_data.size()) && is_live_at(m_ids.index(id));
+        }
+
+    private:
+        friend class id_reservation<T, Allocator, Traits>;
+
+        template<typename, typename, typename>
+        friend class optimistic_vector;
+
+        template<typename, std::size_t, typename, typename>
+        friend class epoch_vector;
+
+#if SIV_COROUTINES
+        friend struct detail::interleaver;
+#endif
+
+        void check_at(id_type id) const
+        {
+            if (!contains(id)) {
+#if SIV_EXCEPTIONS
+                throw std::out_of_range("siv::vector::at: invalid id");
+#else
+                assert(false && "siv::vector::at: invalid id");
+#endif
+            }
+        }
+
+        id_type get_free_slot()
+        {
+            if constexpr (has_tombstones) {
+                // Make room for the flag up front so that commit_slot() cannot fail
+                detail::reserve_one_more(m_dead);
+            }
+            return m_ids.acquire(m_data.size());
+        }
+
+        /** Runs `construct`, which appends the element of the ID just taken by get_free_slot(), then
+         *  commits the slot. If it throws, the ID goes back to the free IDs. The recycling queue only
+         *  makes room for it then: if that fails too, the ID stays free but unqueued until shrink_to_fit().
+         */
+        template<typename Construct>
+        void construct_slot(Construct&& construct)
+        {
+#if SIV_EXCEPTIONS
+            try {
+                construct();
+            } catch (...) {
+                m_ids.cancel_acquire(m_data.size());
+                throw;
+            }
+#else
+            construct();
+#endif
+            commit_slot();
+        }
+
+        /** Bulk insertion: reserves every table once, assigns `n` IDs to the next positions, then
+         *  lets `append` construct exactly `n` elements (or none if it throws).
+         */
+        template<typename Append>
+        void append_n(size_type n, span<id_type> out, Append&& append)
+        {
+            assert((out.empty() || out.size() >= n) && "Output span too small");
+            const size_type first = m_data.size();
+            detail::reserve_more(m_data, n);
+            m_ids.reserve_more(n);
+            if constexpr (has_tombstones) {
+                detail::reserve_more(m_dead, n);
+            }
+            m_ids.prepare_release(n);
+            m_ids.acquire_n(first, n, out.empty() ? nullptr : out.data());
+#if SIV_EXCEPTIONS
+            try {
+                append();
+            } catch (...) {
+                // Recycle the IDs acquired for positions that ended up without an element
+                m_ids.release_unused(m_data.size(), first + n);
+                throw;
+            }
+#else
+            append();
+#endif
+            if constexpr (has_tombstones) {
+                for (size_type i{0}; i < n; ++i) {
+                    m_dead.push_back(false);
+                }
+            }
+            if constexpr (has_observer) {
+                for (size_type pos = first; pos < m_data.size(); ++pos) {
+                    notify_insert(pos);
+                }
+            }
+        }
+
+        /// Runs `append`, destroying what it appended if it throws
+        template<typename Append>
+        void append_or_rollback(Append&& append)
+        {
+#if SIV_EXCEPTIONS
+            const size_type first = m_data.size();
+            try {
+                append();
+            } catch (...) {
+                while (m_data.size() > first) {
+                    m_data.pop_back();
+                }
+                throw;
+            }
+#else
+            append();
+#endif
+        }
+
+        /** Calls fn(i, pos) with the data position of ids[i], for every i in order. Software pipeline:
+         *  the index entry of ids[i + 2d] and the element of ids[i + d] are prefetched before ids[i]
+         *  is resolved, d being detail::prefetch_distance.
+         */
+        template<typename Fn>
+        void resolve(span<const id_type> ids, Fn&& fn) const
+        {
+            constexpr size_type distance = detail::prefetch_distance;
+            const size_type n = ids.size();
+            for (size_type i{0}; i < std::min(n, 2 * distance); ++i) {
+                m_ids.prefetch(ids[i]);
+            }
+            for (size_type i{0}; i < n; ++i) {
+                if (i + 2 * distance < n) {
+                    m_ids.prefetch(ids[i + 2 * distance]);
+                }
+                if (i + distance < n && m_ids.contains(ids[i + distance], m_data.size())) {
+                    detail::prefetch(&m_data[m_ids.index(ids[i + distance])]);
+                }
+                fn(i, m_ids.index(ids[i]));
+            }
+        }
+
+        /// Calls fn(pos, element) for every live position in [begin, end)
+        template<typename Self, typename Fn>
+        static void visit(Self& self, size_type begin, size_type end, Fn&& fn)
+        {
+            for (size_type pos = begin; pos < end; ++pos) {
+                if constexpr (has_tombstones) {
+                    if (self.m_dead[pos]) {
+                        continue;
+                    }
+                }
+                fn(pos, self.m_data[pos]);
+            }
+        }
+
+        /// Calls fn(id, value) if fn takes the stable ID first, fn(value) otherwise
+        template<typename Fn, typename Value>
+        decltype(auto) invoke_element(Fn& fn, size_type pos, Value& value) const
+        {
+            if constexpr (std::is_invocable_v<Fn&, id_type, Value&>) {
+                return fn(m_ids.rid(pos), value);
+            } else {
+                return fn(value);
+            }
+        }
+
+        /// The vector's allocator, rebound for a scratch_type<U>
+        template<typename U>
+        [[nodiscard]] typename scratch_type<U>::allocator_type scratch_allocator() const
+        {
+            return typename scratch_type<U>::allocator_type(get_allocator());
+        }
+
+        /// Moves the survivor at `src` into the hole left by an erased element
+        void move_slot(size_type hole, size_type src)
+        {
+            notify_relocate(src, hole);
+            m_data[hole] = std::move(m_data[src]);
+        }
+
+        /** Releases every position flagged in `dead`, notifying the observer of each erasure first.
+         *  The concurrent release is only taken without an observer, whose callbacks stay single-threaded.
+         */
+        void erase_flagged(const scratch_type<unsigned char>& dead, bool parallel)
+        {
+            const size_type n = dead.size();
+            if constexpr (has_observer) {
+                for (size_type pos{0}; pos < n; ++pos) {
+                    if (dead[pos]) {
+                        notify_erase(pos);
+                    }
+                }
+            }
+            if (!has_observer && parallel && std::is_nothrow_move_assignable_v<T> && detail::parallel_chunks(n) > 1) {
+                m_ids.release_flagged(n, dead.data(),
+                                      [this](size_type hole, size_type src) { move_slot(hole, src); },
+                                      [this](size_type new_size) { truncate(new_size); });
+            } else {
+                m_ids.release_where(n,
+                                    [&](size_type i) -> bool { return dead[i] != 0; },
+                                    [this](size_type hole, size_type src) { move_slot(hole, src); },
+                                    [this](size_type new_size) { truncate(new_size); });
+            }
+        }
+
+        // Observer notifications: positions are read before the ID table is updated
+
+        void notify_insert([[maybe_unused]] size_type pos) noexcept
+        {
+            if constexpr (has_observer) {
+                m_observer.on_insert(m_ids.rid(pos), pos);
+            }
+        }
+
+        void notify_erase([[maybe_unused]] size_type pos) noexcept
+        {
+            if constexpr (has_observer) {
+                m_observer.on_erase(m_ids.rid(pos), pos);
+            }
+        }
+
+        void notify_relocate([[maybe_unused]] size_type from, [[maybe_unused]] size_type to) noexcept
+        {
+            if constexpr (has_observer) {
+                m_observer.on_relocate(m_ids.rid(from), from, to);
+            }
+        }
+
+        void truncate(size_type new_size)
+        {
+            while (m_data.size() > new_size) {
+                m_data.pop_back();
+            }
+        }
+
+        /// Records the liveness of the slot appended by the last insertion
+        void commit_slot() noexcept
+        {
+            if constexpr (has_tombstones) {
+                m_dead.push_back(false);
+            }
+        }
+
+        void kill(id_type id)
+        {
+            assert(contains(id) && "Object already erased or ID invalid");
+            const size_type idx = m_ids.index(id);
+            notify_erase(idx);
+            m_ids.kill(id);
+            m_dead[idx] = true;
+            ++m_holes;
+        }
+
+        template<bool Stable, bool Parallel, typename Compare>
+        void sort_impl(Compare& comp)
+        {
+            compact();
+            scratch_type<size_type> order(m_data.size(), scratch_allocator<size_type>());
+            std::iota(order.begin(), order.end(), size_type{0});
+            auto by_element = [this, &comp](size_type a, size_type b) {
+                return comp(std::as_const(m_data[a]), std::as_const(m_data[b]));
+            };
+            if constexpr (Parallel) {
+                detail::parallel_sort<Stable>(order.data(), order.size(), by_element);
+            } else if constexpr (Stable) {
+                std::stable_sort(order.begin(), order.end(), by_element);
+            } else {
+                std::sort(order.begin(), order.end(), by_element);
+            }
+            permute<Parallel>(order);
+        }
+
+        /** The permutation of the data indexes `perm` restated for the live elements, then compact():
+         *  the data index each live slot will have after compaction, in the order of `perm`. Without
+         *  holes, a copy of `perm`.
+         */
+        scratch_type<size_type> compacted_order(span<const size_type> perm)
+        {
+            if constexpr (has_tombstones) {
+                if (m_holes != 0) {
+                    const size_type slots = m_data.size();
+                    assert(perm.size() == slots && "Permutation size mismatch");
+                    assert(detail::is_permutation(perm.data(), slots) && "Not a permutation");
+                    // compact() keeps the survivors in order: a live slot moves to its rank among them
+                    scratch_type<size_type> rank(slots, scratch_allocator<size_type>());
+                    size_type live{0};
+                    for (size_type pos{0}; pos < slots; ++pos) {
+                        rank[pos] = live;
+                        live += m_dead[pos] ? 0 : 1;
+                    }
+                    scratch_type<size_type> order(scratch_allocator<size_type>());
+                    order.reserve(live);
+                    for (const size_type pos : perm) {
+                        if (!m_dead[pos]) {
+                            order.push_back(rank[pos]);
+                        }
+                    }
+                    compact();
+                    return order;
+                }
+            }
+            return scratch_type<size_type>(perm.begin(), perm.end(), scratch_allocator<size_type>());
+        }
+
+        /** Moves the element at perm[i] to i, for every i. Element moves are assumed not to throw.
+         *  The sequential path follows the permutation cycles in place and consumes `perm`.
+         *  With siv::relocating_storage, elements are relocated with memcpy instead of moved.
+         */
+        template<bool Parallel>
+        void permute(scratch_type<size_type>& perm)
+        {
+            const size_type n = m_data.size();
+            assert(m_holes == 0 && "compact() before permuting");
+            assert(perm.size() == n && "Permutation size mismatch");
+            assert(detail::is_permutation(perm.data(), n) && "Not a permutation");
+            if constexpr (has_observer) {
+                for (size_type i{0}; i < n; ++i) {
+                    if (perm[i] != i) {
+                        notify_relocate(perm[i], i);
+                    }
+                }
+            }
+            if constexpr (Parallel) {
+                if (detail::parallel_chunks(n) > 1) {
+                    using buffer_alloc  = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+                    using buffer_traits = std::allocator_traits<buffer_alloc>;
+                    buffer_alloc alloc(get_allocator());
+                    // Allocate before touching the tables so that a failure leaves everything intact
+                    T* const buffer = buffer_traits::allocate(alloc, n);
+                    m_ids.template permute<true>(perm.data(), n);
+                    if constexpr (relocates) {
+                        detail::parallel_for(n, [&](size_type begin, size_type end) {
+                            for (size_type i = begin; i < end; ++i) {
+                                relocate_bytes(buffer + i, &m_data[perm[i]]);
+                            }
+                        });
+                        detail::parallel_for(n, [&](size_type begin, size_type end) {
+                            std::memcpy(static_cast<void*>(&m_data[begin]), buffer + begin, (end - begin) * sizeof(T));
+                        });
+                    } else {
+                        detail::parallel_for(n, [&](size_type begin, size_type end) {
+                            for (size_type i = begin; i < end; ++i) {
+                                buffer_traits::construct(alloc, buffer + i, std::move(m_data[perm[i]]));
+                            }
+                        });
+                        detail::parallel_for(n, [&](size_type begin, size_type end) {
+                            for (size_type i = begin; i < end; ++i) {
+                                m_data[i] = std::move(buffer[i]);
+                                buffer_traits::destroy(alloc, buffer + i);
+                            }
+                        });
+                    }
+                    buffer_traits::deallocate(alloc, buffer, n);
+                    return;
+                }
+            }
+            m_ids.template permute<Parallel>(perm.data(), n);
+            if constexpr (relocates) {
+                for (size_type start{0}; start < n; ++start) {
+                    if (perm[start] == start) {
+                        continue;
+                    }
+                    alignas(T) unsigned char carried[sizeof(T)];
+                    relocate_bytes(carried, &m_data[start]);
+                    size_type hole = start;
+                    for (size_type src = perm[hole]; src != start; src = perm[hole]) {
+                        relocate_bytes(&m_data[hole], &m_data[src]);
+                        perm[hole] = hole;
+                        hole = src;
+                    }
+                    relocate_bytes(&m_data[hole], carried);
+                    perm[hole] = hole;
+                }
+                return;
+            }
+            for (size_type start{0}; start < n; ++start) {
+                if (perm[start] == start) {
+                    continue;
+                }
+                T carried = std::move(m_data[start]);
+                size_type hole = start;
+                for (size_type src = perm[hole]; src != start; src = perm[hole]) {
+                    m_data[hole] = std::move(m_data[src]);
+                    perm[hole] = hole;
+                    hole = src;
+                }
+                m_data[hole] = std::move(carried);
+                perm[hole] = hole;
+            }
+        }
+
+        /// Copies the bytes of one element: relocation of trivially relocatable elements
+        static void relocate_bytes(void* dst, const void* src) noexcept
+        {
+            std::memcpy(dst, src, sizeof(T));
+        }
+
+        void compact_if_needed()
+        {
+            if (static_cast<double>(m_holes) > m_max_hole_ratio * static_cast<double>(m_data.size())) {
+                compact();
+            }
+        }
+
+        template<typename Iterator, typename Storage>
+        Iterator make_iterator(Storage& data, size_type pos) const noexcept
+        {
+            if constexpr (has_tombstones) {
+                return Iterator(data.begin() + static_cast<difference_type>(pos), &m_dead, pos, data.size());
+            } else {
+                return data.begin() + static_cast<difference_type>(pos);
+            }
+        }
+
+        static flags_type make_flags([[maybe_unused]] const Allocator& alloc)
+        {
+            if constexpr (has_tombstones) {
+                return flags_type(flags_allocator_type(alloc));
+            } else {
+                return {};
+            }
+        }
+
+        static constexpr bool has_key = !std::is_same_v<key_type, detail::no_key>;
+
+        storage_type   m_data;
+        id_table_type  m_ids;
+        flags_type     m_dead;
+        observer_type  m_observer; // Empty by default: shares the padding after m_dead
+        size_type      m_holes          = 0;
+        double         m_max_hole_ratio = Traits::max_hole_ratio;
+    };
+
+    /** A collection of handles into one siv::vector that drops the stale ones in bulk.
+     *  sweep() validates every handle with vector::validate() and compacts the survivors in
+     *  place, keeping their order. Handles of other vectors count as stale.
+     *
+     * @tparam T, Allocator, Traits The parameters of the siv::vector the handles refer to
+     */
+    template<typename T, typename Allocator, typename Traits>
+    class handle_set
+    {
+    public:
+        using vector_type    = vector<T, Allocator, Traits>;
+        using handle_type    = typename vector_type::handle_type;
+        using id_type        = typename vector_type::id_type;
+        using value_type     = handle_type;
+        using size_type      = std::size_t;
+        using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<handle_type>;
+
+    private:
+        using storage_type = std::vector<handle_type, allocator_type>;
+
+    public:
+        using iterator       = typename storage_type::const_iterator;
+        using const_iterator = typename storage_type::const_iterator;
+
+        explicit handle_set(vector_type& v)
+            : m_vector{&v}
+            , m_handles(allocator_type(v.get_allocator()))
+        {}
+
+        void insert(const handle_type& h)
+        {
+            m_handles.push_back(h);
+        }
+
+        /// Inserts a handle to the live object `id` and returns it
+        handle_type insert(id_type id)
+        {
+            m_handles.push_back(m_vector->make_handle(id));
+            return m_handles.back();
+        }
+
+        /** Removes every handle whose object was erased, in one pass.
+         *  @return The number of handles removed
+         */
+        size_type sweep()
+        {
+            constexpr size_type block = 256;
+            bool live[block];
+            size_type kept{0};
+            for (size_type first{0}; first < m_handles.size(); first += block) {
+                const size_type n = std::min(block, m_handles.size() - first);
+                m_vector->validate(span<const handle_type>(m_handles.data() + first, n), span<bool>(live, n));
+                for (size_type i{0}; i < n; ++i) {
+                    m_handles[kept] = m_handles[first + i];
+                    kept += live[i] ? 1 : 0;
+                }
+            }
+            const size_type removed = m_handles.size() - kept;
+            m_handles.resize(kept);
+            return removed;
+        }
+
+        void reserve(size_type n) { m_handles.reserve(n); }
+        void clear() noexcept     { m_handles.clear();    }
+
+        [[nodiscard]] size_type size()  const noexcept { return m_handles.size();  }
+        [[nodiscard]] bool      empty() const noexcept { return m_handles.empty(); }
+
+        const_iterator begin() const noexcept { return m_handles.begin(); }
+        const_iterator end()   const noexcept { return m_handles.end();   }
+
+        /// The vector the handles refer to
+        [[nodiscard]]
+        vector_type& target() const noexcept
+        {
+            return *m_vector;
+        }
+
+    private:
+        vector_type*  m_vector;
+        storage_type  m_handles;
+    };
+
+    /** A block of IDs reserved by vector::reserve_ids() for objects constructed later.
+     *  Worker threads claim IDs from the block with claim(), lock-free, so that objects created in the
+     *  same tick can reference each other before they exist. The thread owning the vector then
+     *  constructs them with vector::emplace_reserved(), typically in bulk at a sync point. IDs never
+     *  constructed return to the free IDs when the reservation is destroyed or passed to
+     *  vector::release_ids(). The block must be filled (by reserve_ids()) before it is shared with
+     *  other threads, and must not outlive the vector.
+     *
+     * @tparam T, Allocator, Traits The parameters of the siv::vector the IDs belong to
+     */
+    template<typename T, typename Allocator, typename Traits>
+    class id_reservation
+    {
+    public:
+        using vector_type     = vector<T, Allocator, Traits>;
+        using id_type         = typename vector_type::id_type;
+        using generation_type = typename vector_type::generation_type;
+        using size_type       = std::size_t;
+
+        id_reservation(const id_reservation&) = delete;
+        id_reservation& operator=(const id_reservation&) = delete;
+
+        ~id_reservation()
+        {
+            m_vector->release_ids(*this);
+        }
+
+        /// Claims one ID from any thread, or returns vector_type::invalid_id once the block is exhausted
+        [[nodiscard]]
+        id_type claim() noexcept
+        {
+            const span<const id_type> ids = claim(1);
+            return ids.empty() ? vector_type::invalid_id : ids[0];
+        }
+
+        /// Claims `n` IDs at once from any thread, or none (an empty span) if fewer are left
+        [[nodiscard]]
+        span<const id_type> claim(size_type n) noexcept
+        {
+            size_type next = m_next.load(std::memory_order_relaxed);
+            do {
+                if (n > m_ids.size() - std::min(next, m_ids.size())) {
+                    return {};
+                }
+            } while (!m_next.compare_exchange_weak(next, next + n, std::memory_order_relaxed));
+            return {m_ids.data() + next, n};
+        }
+
+        /// Number of IDs in the block
+        [[nodiscard]]
+        size_type size() const noexcept
+        {
+            return m_ids.size();
+        }
+
+        /// Number of IDs claimed so far
+        [[nodiscard]]
+        size_type claimed() const noexcept
+        {
+            return std::min(m_next.load(std::memory_order_relaxed), m_ids.size());
+        }
+
+        /// The vector the IDs belong to
+        [[nodiscard]]
+        vector_type& target() const noexcept
+        {
+            return *m_vector;
+        }
+
+    private:
+        friend class vector<T, Allocator, Traits>;
+        friend class command_queue<T, Allocator, Traits>;
+
+        using id_allocator_type         = typename std::allocator_traits<Allocator>::template rebind_alloc<id_type>;
+        using generation_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<generation_type>;
+        using flag_allocator_type       = typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned char>;
+
+        id_reservation(vector_type& v, size_type n)
+            : m_vector{&v}
+            , m_ids(id_allocator_type(v.get_allocator()))
+            , m_generations(generation_allocator_type(v.get_allocator()))
+            , m_taken(flag_allocator_type(v.get_allocator()))
+        {
+            fill(n);
+        }
+
+        /// Drops the IDs constructed so far and reserves new ones until the block holds `n` IDs again
+        void fill(size_type n)
+        {
+            vector_type& v = *m_vector;
+            size_type kept{0};
+            for (size_type i{0}; i < m_ids.size(); ++i) {
+                if (!m_taken[i]) {
+                    m_ids[kept]         = m_ids[i];
+                    m_generations[kept] = m_generations[i];
+                    ++kept;
+                }
+            }
+            m_ids.resize(kept);
+            m_generations.resize(kept);
+            m_taken.assign(kept, 0);
+            m_hint = 0;
+            m_ids.reserve(n);
+            m_generations.reserve(n);
+            m_taken.reserve(n);
+#if SIV_EXCEPTIONS
+            try {
+#endif
+                // Each ID is recorded as soon as it is detached, so that a failure part-way releases it
+                while (m_ids.size() < n) {
+                    generation_type generation{};
+                    m_ids.push_back(v.m_ids.detach(v.m_data.size(), generation));
+                    m_generations.push_back(generation);
+                    m_taken.push_back(0);
+                }
+                sort_by_id(kept);
+#if SIV_EXCEPTIONS
+            } catch (...) {
+                v.release_ids(*this);
+                throw;
+            }
+#endif
+        }
+
+        /// Orders the IDs ascending, so that take() is a binary search. The first `sorted` already are.
+        void sort_by_id(size_type sorted)
+        {
+            const auto tail = static_cast<std::ptrdiff_t>(sorted);
+            // Fresh IDs come out ascending and recycled ones descending
+            if (std::is_sorted(m_ids.begin() + tail, m_ids.end(), std::greater<>{})) {
+                std::reverse(m_ids.begin() + tail, m_ids.end());
+                std::reverse(m_generations.begin() + tail, m_generations.end());
+            }
+            if (std::is_sorted(m_ids.begin(), m_ids.end())) {
+                return;
+            }
+            std::vector<std::pair<id_type, generation_type>> pairs(m_ids.size());
+            for (size_type i{0}; i < m_ids.size(); ++i) {
+                pairs[i] = {m_ids[i], m_generations[i]};
+            }
+            std::sort(pairs.begin() + tail, pairs.end());
+            std::inplace_merge(pairs.begin(), pairs.begin() + tail, pairs.end());
+            for (size_type i{0}; i < m_ids.size(); ++i) {
+                m_ids[i]         = pairs[i].first;
+                m_generations[i] = pairs[i].second;
+            }
+        }
+
+        /// Marks `id` as constructed and returns the generation it had when reserved
+        [[nodiscard]]
+        generation_type take(id_type id) noexcept
+        {
+            // IDs are usually constructed in the order they were claimed
+            size_type i = m_hint;
+            if (i >= m_ids.size() || m_ids[i] != id) {
+                i = static_cast<size_type>(std::lower_bound(m_ids.begin(), m_ids.end(), id) - m_ids.begin());
+            }
+            assert(i < m_ids.size() && m_ids[i] == id && "ID not in this reservation");
+            assert(!m_taken[i] && "ID already constructed");
+            m_taken[i] = 1;
+            m_hint     = i + 1;
+            return m_generations[i];
+        }
+
+        vector_type*                                            m_vector;
+        std::vector<id_type, id_allocator_type>                 m_ids;
+        std::vector<generation_type, generation_allocator_type> m_generations;
+        std::vector<unsigned char, flag_allocator_type>         m_taken;
+        size_type                                               m_hint{0};
+        std::atomic<size_type>                                  m_next{0};
+    };
+
+    /** Operations recorded by one thread for a later command_queue::flush().
+     *  emplace() constructs the object in the buffer and returns its ID right away, taken from a
+     *  slice of IDs reserved for this buffer; erase() only records the ID. The vector is not touched.
+     *  Each buffer sits on its own cache lines, so that threads recording side by side do not
+     *  invalidate each other's.
+     *
+     * @tparam T, Allocator, Traits The parameters of the siv::vector the commands apply to
+     */
+    template<typename T, typename Allocator, typename Traits>
+    class alignas(64) command_buffer
+    {
+    public:
+        using vector_type = vector<T, Allocator, Traits>;
+        using id_type     = typename vector_type::id_type;
+        using size_type   = std::size_t;
+
+        /** Constructs an object to insert at the next flush and returns its ID, which other recorded
+         *  objects may already reference. Throws std::length_error (or asserts with -fno-exceptions)
+         *  once the IDs reserved for this buffer are used up.
+         */
+        template<typename... Args>
+        [[nodiscard]]
+        id_type emplace(Args&&... args)
+        {
+            if (m_used == m_ids.size()) {
+#if SIV_EXCEPTIONS
+                throw std::length_error("siv::command_buffer: reserved IDs exhausted");
+#else
+                assert(false && "siv::command_buffer: reserved IDs exhausted");
+#endif
+            }
+            m_values.emplace_back(std::forward<Args>(args)...);
+            return m_ids[m_used++];
+        }
+
+        /// Records the erasure of `id`. A no-op at flush if the object is dead by then.
+        void erase(id_type id)
+        {
+            m_erased.push_back(id);
+        }
+
+        /// Number of objects recorded for insertion
+        [[nodiscard]]
+        size_type pending_inserts() const noexcept
+        {
+            return m_used;
+        }
+
+        /// Number of erasures recorded
+        [[nodiscard]]
+        size_type pending_erases() const noexcept
+        {
+            return m_erased.size();
+        }
+
+        /// Number of emplace() calls left before the next flush
+        [[nodiscard]]
+        size_type available() const noexcept
+        {
+            return m_ids.size() - m_used;
+        }
+
+    private:
+        friend class command_queue<T, Allocator, Traits>;
+
+        using id_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<id_type>;
+
+        explicit command_buffer(const Allocator& allocator)
+            : m_values(allocator)
+            , m_erased(id_allocator_type(allocator))
+        {}
+
+        /// Drops the recorded commands and takes a new slice of reserved IDs
+        void reset(span<const id_type> ids) noexcept
+        {
+            m_ids  = ids;
+            m_used = 0;
+            m_values.clear();
+            m_erased.clear();
+        }
+
+        span<const id_type>                      m_ids;
+        size_type                                m_used{0};
+        std::vector<T, Allocator>                m_values;
+        std::vector<id_type, id_allocator_type>  m_erased;
+    };
+
+    /** Per-thread command buffers merged into a siv::vector at a sync point.
+     *  Thread `i` records into buffer(i) while no thread touches the vector. The owner thread then
+     *  calls flush(), which applies every buffer in index order: first all insertions, then all
+     *  erasures in one batched erase. The IDs handed out by each buffer are reserved up front, one
+     *  fixed slice per buffer, so the result of a flush only depends on what each buffer recorded and
+     *  not on how the threads were scheduled. The queue must not outlive the vector.
+     *
+     * @tparam T, Allocator, Traits The parameters of the siv::vector the commands apply to
+     */
+    template<typename T, typename Allocator, typename Traits>
+    class command_queue
+    {
+    public:
+        using vector_type      = vector<T, Allocator, Traits>;
+        using buffer_type      = command_buffer<T, Allocator, Traits>;
+        using id_type          = typename vector_type::id_type;
+        using size_type        = std::size_t;
+        using reservation_type = id_reservation<T, Allocator, Traits>;
+
+        /** Creates `buffer_count` buffers, each able to record `ids_per_buffer` insertions per flush.
+         *  Reserves buffer_count * ids_per_buffer IDs of `v` until the queue is destroyed.
+         */
+        command_queue(vector_type& v, size_type buffer_count, size_type ids_per_buffer)
+            : m_vector{&v}
+            , m_reservation(v.reserve_ids(buffer_count * ids_per_buffer))
+            , m_buffers(buffer_allocator_type(v.get_allocator()))
+            , m_erased(id_allocator_type(v.get_allocator()))
+            , m_ids_per_buffer{ids_per_buffer}
+        {
+            m_buffers.reserve(buffer_count);
+            for (size_type i{0}; i < buffer_count; ++i) {
+                m_buffers.push_back(buffer_type(v.get_allocator()));
+            }
+            distribute();
+        }
+
+        command_queue(const command_queue&) = delete;
+        command_queue& operator=(const command_queue&) = delete;
+
+        /// The buffer of thread `i`; each buffer must be used by one thread at a time
+        [[nodiscard]]
+        buffer_type& buffer(size_type i) noexcept
+        {
+            assert(i < m_buffers.size() && "Buffer index out of range");
+            return m_buffers[i];
+        }
+
+        /// Number of buffers
+        [[nodiscard]]
+        size_type size() const noexcept
+        {
+            return m_buffers.size();
+        }
+
+        /** Applies the recorded commands to the vector, then empties the buffers and reserves their IDs
+         *  again. Insertions are appended in buffer order, then recorded order; erasures of dead or
+         *  already erased IDs are skipped. Called from the thread owning the vector, with no thread
+         *  recording. If a constructor throws, the objects already inserted stay and the other
+         *  commands are dropped.
+         */
+        void flush()
+        {
+            vector_type& v = *m_vector;
+            size_type inserts{0};
+            for (const buffer_type& b : m_buffers) {
+                inserts += b.m_used;
+            }
+#if SIV_EXCEPTIONS
+            try {
+#endif
+                v.reserve(v.slot_count() + inserts);
+                for (buffer_type& b : m_buffers) {
+                    for (size_type i{0}; i < b.m_used; ++i) {
+                        v.emplace_reserved(m_reservation, b.m_ids[i], std::move(b.m_values[i]));
+                    }
+                }
+                m_erased.clear();
+                for (const buffer_type& b : m_buffers) {
+                    for (const id_type id : b.m_erased) {
+                        if (v.contains(id)) {
+                            m_erased.push_back(id);
+                        }
+                    }
+                }
+                std::sort(m_erased.begin(), m_erased.end());
+                m_erased.erase(std::unique(m_erased.begin(), m_erased.end()), m_erased.end());
+                v.erase(span<const id_type>(m_erased));
+#if SIV_EXCEPTIONS
+            } catch (...) {
+                // Some slices hold live IDs now: none can be handed out until the next flush
+                clear_buffers();
+                throw;
+            }
+#endif
+            clear_buffers();
+            m_reservation.fill(m_buffers.size() * m_ids_per_buffer);
+            distribute();
+        }
+
+        /// The vector the commands apply to
+        [[nodiscard]]
+        vector_type& target() const noexcept
+        {
+            return *m_vector;
+        }
+
+    private:
+        using buffer_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<buffer_type>;
+        using id_allocator_type     = typename std::allocator_traits<Allocator>::template rebind_alloc<id_type>;
+
+        void clear_buffers() noexcept
+        {
+            for (buffer_type& b : m_buffers) {
+                b.reset({});
+            }
+        }
+
+        /// Hands each buffer its slice of the reserved IDs, in buffer order
+        void distribute() noexcept
+        {
+            m_reservation.m_next.store(0, std::memory_order_relaxed);
+            for (buffer_type& b : m_buffers) {
+                b.reset(m_reservation.claim(m_ids_per_buffer));
+            }
+        }
+
+        vector_type*                                    m_vector;
+        reservation_type                                m_reservation;
+        std::vector<buffer_type, buffer_allocator_type> m_buffers;
+        std::vector<id_type, id_allocator_type>         m_erased;
+        size_type                                       m_ids_per_buffer;
+    };
+
+    // -- Non-member functions --
+
+    /// Erases all elements matching the predicate (C++20-style free function)
+    /// @return The number of elements removed
+    template<typename T, typename Allocator, typename Traits, typename Pred>
+    typename vector<T, Allocator, Traits>::size_type erase_if(vector<T, Allocator, Traits>& v, Pred predicate)
+    {
+        const auto old_size = v.size();
+        v.erase_if(std::move(predicate));
+        return old_size - v.size();
+    }
+
+#if SIV_COROUTINES
+    /** Features kept out of the main API: they work, but have not beaten the alternative they were
+     *  written to replace in any measured workload.
+     */
+    namespace experimental
+    {
+        /** vec.for_each(ids, fn) as interleaved coroutines (AMAC): `group` lookups are in flight at once.
+         *  Each one prefetches its index entry and suspends, then prefetches its element and suspends,
+         *  and a round-robin scheduler resumes the next one. fn runs as soon as its element is resolved,
+         *  so the overlap follows the cost of fn instead of a fixed prefetch distance.
+         *  fn is called once per ID, in roughly but not exactly the order of `ids`. Requires C++20.
+         *  Slower than vector::for_each(ids, fn) in every workload measured so far.
+         */
+        template<typename T, typename Allocator, typename Traits, typename Fn>
+        void for_each_interleaved(vector<T, Allocator, Traits>& vec, span<const typename Traits::id_type> ids, Fn&& fn,
+                                  std::size_t group = detail::interleave_group)
+        {
+            detail::interleaver::run(vec, ids, fn, group);
+        }
+
+        template<typename T, typename Allocator, typename Traits, typename Fn>
+        void for_each_interleaved(const vector<T, Allocator, Traits>& vec, span<const typename Traits::id_type> ids, Fn&& fn,
+                                  std::size_t group = detail::interleave_group)
+        {
+            detail::interleaver::run(vec, ids, fn, group);
+        }
+    }
+#endif
+
+    /// @note Comparisons operate on elements in data-order (internal storage order),
+    /// which may differ from insertion order after deletions (swap-to-back).
+    template<typename T, typename Allocator, typename Traits>
+    bool operator==(const vector<T, Allocator, Traits>& lhs, const vector<T, Allocator, Traits>& rhs)
+    {
+        return lhs.size() == rhs.size()
+            && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<typename T, typename Allocator, typename Traits>
+    bool operator!=(const vector<T, Allocator, Traits>& lhs, const vector<T, Allocator, Traits>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template<typename T, typename Allocator, typename Traits>
+    bool operator<(const vector<T, Allocator, Traits>& lhs, const vector<T, Allocator, Traits>& rhs)
+    {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(),
+                                            rhs.begin(), rhs.end());
+    }
+
+    template<typename T, typename Allocator, typename Traits>
+    bool operator<=(const vector<T, Allocator, Traits>& lhs, const vector<T, Allocator, Traits>& rhs)
+    {
+        return !(rhs < lhs);
+    }
+
+    template<typename T, typename Allocator, typename Traits>
+    bool operator>(const vector<T, Allocator, Traits>& lhs, const vector<T, Allocator, Traits>& rhs)
+    {
+        return rhs < lhs;
+    }
+
+    template<typename T, typename Allocator, typename Traits>
+    bool operator>=(const vector<T, Allocator, Traits>& lhs, const vector<T, Allocator, Traits>& rhs)
+    {
+        return !(lhs < rhs);
+    }
+
+    /** A standalone smart reference to a row of a siv::basic_soa_vector.
+     *  Same validity rules as siv::handle; fields are reached through get<I>().
+     *
+     * @tparam Allocator, Traits, Ts As for the referenced siv::basic_soa_vector
+     */
+    template<typename Allocator, typename Traits, typename... Ts>
+    class basic_soa_handle
+    {
+    public:
+        using id_type         = typename Traits::id_type;
+        using generation_type = typename Traits::generation_type;
+        using vector_type     = basic_soa_vector<Allocator, Traits, Ts...>;
+
+        basic_soa_handle() = default;
+
+        template<std::size_t I>
+        std::tuple_element_t<I, std::tuple<Ts...>>& get()
+        {
+            assert(valid() && "Dereferencing invalid handle");
+            return m_vector->template get<I>(m_id);
+        }
+
+        template<std::size_t I>
+        const std::tuple_element_t<I, std::tuple<Ts...>>& get() const
+        {
+            assert(valid() && "Dereferencing invalid handle");
+            return m_vector->template get<I>(m_id);
+        }
+
+        std::tuple<Ts&...> operator*()
+        {
+            assert(valid() && "Dereferencing invalid handle");
+            return (*m_vector)[m_id];
+        }
+
+        std::tuple<const Ts&...> operator*() const
+        {
+            assert(valid() && "Dereferencing invalid handle");
+            return std::as_const(*m_vector)[m_id];
+        }
+
+        [[nodiscard]]
+        id_type id() const noexcept
+        {
+            return m_id;
+        }
+
+        [[nodiscard]]
+        generation_type generation() const noexcept
+        {
+            return m_generation;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return valid();
+        }
+
+        [[nodiscard]]
+        bool valid() const noexcept
+        {
+            return m_vector && m_vector->is_valid(m_id, m_generation);
+        }
+
+    private:
+        basic_soa_handle(id_type id, generation_type generation, vector_type* vec)
+            : m_id{id}
+            , m_generation{generation}
+            , m_vector{vec}
+        {}
+
+        id_type         m_id         = 0;
+        generation_type m_generation = 0;
+        vector_type*    m_vector     = nullptr;
+
+        friend class basic_soa_vector<Allocator, Traits, Ts...>;
+    };
+
+    /** A structure-of-arrays sibling of siv::vector.
+     *  Each field is stored in its own contiguous column so that passes touching a few fields
+     *  only stream those columns. IDs, handles and erase semantics match siv::vector:
+     *  erasing swaps the last row into the hole, moving every column in lockstep.
+     *  siv::soa_vector<Ts...> is the version with the default allocator and traits.
+     *
+     * @tparam Allocator Rebound for each column and for the ID tables
+     * @tparam Traits    ID/generation widths, recycling policy and column storage, as for
+     *                   siv::vector. The storage must be contiguous and the erase policy swap_and_pop.
+     * @tparam Ts        The column types. Each must be move-constructible and move-assignable.
+     */
+    template<typename Allocator, typename Traits, typename... Ts>
+    class basic_soa_vector
+    {
+        static_assert(sizeof...(Ts) > 0, "soa_vector needs at least one column");
+        static_assert((!std::is_same_v<std::remove_cv_t<Ts>, bool> && ...),
+                      "bool columns are not supported (std::vector<bool> stores proxies): use unsigned char");
+        static_assert(Traits::erase_mode == erase_policy::swap_and_pop, "Tombstones are not supported");
+        static_assert(std::is_same_v<typename Traits::observer, no_observer>, "Observers are not supported");
+
+        template<typename U>
+        using column_storage = typename Traits::template storage<U, typename std::allocator_traits<Allocator>::template rebind_alloc<U>>;
+
+        static_assert((detail::has_data<column_storage<Ts>>::value && ...), "Columns need contiguous storage");
+
+        using columns_type = std::tuple<column_storage<Ts>...>;
+        using indices_type = std::index_sequence_for<Ts...>;
+
+    public:
+        // -- Member types --
+
+        using value_type      = std::tuple<Ts...>;
+        using allocator_type  = Allocator;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference       = std::tuple<Ts&...>;
+        using const_reference = std::tuple<const Ts&...>;
+        using id_type         = typename Traits::id_type;
+        using generation_type = typename Traits::generation_type;
+        using handle_type     = basic_soa_handle<Allocator, Traits, Ts...>;
+
+        template<std::size_t I>
+        using column_type = std::tuple_element_t<I, value_type>;
+
+        static constexpr size_type column_count = sizeof...(Ts);
+
+        // -- Constructors / assignment --
+
+        basic_soa_vector()
+            : basic_soa_vector(Allocator())
+        {}
+
+        explicit basic_soa_vector(const Allocator& allocator)
+            : m_columns(typename std::allocator_traits<Allocator>::template rebind_alloc<Ts>(allocator)...)
+            , m_ids(allocator)
+        {}
+
+        /// Non-copyable and non-movable to prevent dangling handle pointers
+        basic_soa_vector(const basic_soa_vector&) = delete;
+        basic_soa_vector& operator=(const basic_soa_vector&) = delete;
+        basic_soa_vector(basic_soa_vector&&) = delete;
+        basic_soa_vector& operator=(basic_soa_vector&&) = delete;
+
+        [[nodiscard]]
+        allocator_type get_allocator() const noexcept
+        {
+            return allocator_type(std::get<0>(m_columns).get_allocator());
+        }
+
+        // -- Element access --
+
+        /** Bounds-checked access to a whole row by ID.
+         *  @throws std::out_of_range if exceptions are enabled, otherwise asserts
+         */
+        reference at(id_type id)
+        {
+            check_at(id);
+            return row(m_ids.index(id), indices_type{});
+        }
+
+        const_reference at(id_type id) const
+        {
+            check_at(id);
+            return row(m_ids.index(id), indices_type{});
+        }
+
+        /// Access a whole row by stable ID (no bounds checking)
+        reference operator[](id_type id)
+        {
+            return row(m_ids.index(id), indices_type{});
+        }
+
+        const_reference operator[](id_type id) const
+        {
+            return row(m_ids.index(id), indices_type{});
+        }
+
+        /// Access a single field by stable ID (no bounds checking)
+        template<std::size_t I>
+        column_type<I>& get(id_type id)
+        {
+            return std::get<I>(m_columns)[m_ids.index(id)];
+        }
+
+        template<std::size_t I>
+        const column_type<I>& get(id_type id) const
+        {
+            return std::get<I>(m_columns)[m_ids.index(id)];
+        }
+
+        /// Access a whole row by data index
+        reference row_at(size_type idx)
+        {
+            assert(idx < size() && "Index out of range");
+            return row(idx, indices_type{});
+        }
+
+        const_reference row_at(size_type idx) const
+        {
+            assert(idx < size() && "Index out of range");
+            return row(idx, indices_type{});
+        }
+
+        // -- Columns --
+
+        /// Contiguous view of column I in data order, for vectorized passes
+        template<std::size_t I>
+        span<column_type<I>> column() noexcept
+        {
+            auto& c = std::get<I>(m_columns);
+            return {c.data(), c.size()};
+        }
+
+        template<std::size_t I>
+        span<const column_type<I>> column() const noexcept
+        {
+            const auto& c = std::get<I>(m_columns);
+            return {c.data(), c.size()};
+        }
+
+        template<std::size_t I>
+        column_type<I>* data() noexcept
+        {
+            return std::get<I>(m_columns).data();
+        }
+
+        template<std::size_t I>
+        const column_type<I>* data() const noexcept
+        {
+            return std::get<I>(m_columns).data();
+        }
+
+        // -- Capacity --
+
+        [[nodiscard]] bool      empty()    const noexcept { return std::get<0>(m_columns).empty();    }
+        [[nodiscard]] size_type size()     const noexcept { return std::get<0>(m_columns).size();     }
+        [[nodiscard]] size_type capacity() const noexcept { return std::get<0>(m_columns).capacity(); }
+
+        void reserve(size_type new_cap)
+        {
+            std::apply([new_cap](auto&... c) { (c.reserve(new_cap), ...); }, m_columns);
+            m_ids.reserve(new_cap);
+        }
+
+        /// Shrinks the columns, and the ID tables down to the highest live ID (see siv::vector::shrink_to_fit)
+        void shrink_to_fit()
+        {
+            std::apply([](auto&... c) { (c.shrink_to_fit(), ...); }, m_columns);
+            m_ids.shrink(size());
+        }
+
+        // -- Modifiers --
+
+        /// Removes all rows and invalidates all existing handles
+        void clear()
+        {
+            m_ids.release_all(size());
+            std::apply([](auto&... c) { (c.clear(), ...); }, m_columns);
+        }
+
+        /** Copies the provided row at the end of every column
+         *  @return The stable ID to retrieve the row
+         */
+        [[nodiscard]]
+        id_type push_back(const value_type& value)
+        {
+            return std::apply([this](const Ts&... fields) { return emplace_back(fields...); }, value);
+        }
+
+        /** Moves the provided row at the end of every column
+         *  @return The stable ID to retrieve the row
+         */
+        [[nodiscard]]
+        id_type push_back(value_type&& value)
+        {
+            return std::apply([this](Ts&... fields) { return emplace_back(std::move(fields)...); }, value);
+        }
+
+        /** Constructs a row in-place, one argument per column
+         *  @return The stable ID to retrieve the row
+         */
+        template<typename... Args>
+        [[nodiscard]]
+        id_type emplace_back(Args&&... args)
+        {
+            static_assert(sizeof...(Args) == sizeof...(Ts), "emplace_back takes one argument per column");
+            const id_type id = m_ids.acquire(size());
+#if SIV_EXCEPTIONS
+            try {
+                emplace_columns(indices_type{}, std::forward<Args>(args)...);
+            } catch (...) {
+                m_ids.cancel_acquire(size());
+                throw;
+            }
+#else
+            emplace_columns(indices_type{}, std::forward<Args>(args)...);
+#endif
+            return id;
+        }
+
+        /// Removes the last row in data order
+        void pop_back()
+        {
+            assert(!empty() && "pop_back on empty vector");
+            erase_at(size() - 1);
+        }
+
+        /** Removes the row referenced by the provided stable ID
+         *  @param id The stable ID of the row to remove
+         */
+        void erase(id_type id)
+        {
+            const size_type data_idx = m_ids.release(id, size());
+            std::apply([data_idx](auto&... c) {
+                ((std::swap(c[data_idx], c.back()), c.pop_back()), ...);
+            }, m_columns);
+        }
+
+        /** Removes the row referenced by the handle
+         *  @param h A handle to the row to remove
+         */
+        void erase(const handle_type& h)
+        {
+            assert(h.m_vector == this && "Handle does not belong to this vector");
+            assert(h.valid() && "Handle references an erased object");
+            erase(h.id());
+        }
+
+        /** Removes the row at the given data index
+         *  @param idx Position in the columns
+         */
+        void erase_at(size_type idx)
+        {
+            assert(idx < size() && "Index out of range");
+            erase(m_ids.rid(idx));
+        }
+
+        /** Removes all rows matching the predicate
+         *  @param predicate Unary predicate taking a const_reference row
+         */
+        template<typename Pred>
+        void erase_if(Pred&& predicate)
+        {
+            m_ids.release_where(size(),
+                                [&](size_type i) -> bool { return predicate(std::as_const(*this).row_at(i)); },
+                                [this](size_type hole, size_type src) {
+                                    std::apply([hole, src](auto&... c) { ((c[hole] = std::move(c[src])), ...); }, m_columns);
+                                },
+                                [this](size_type new_size) {
+                                    std::apply([new_size](auto&... c) { (truncate(c, new_size), ...); }, m_columns);
+                                });
+        }
+
+        // -- Stable-ID specific operations --
+
+        /// Returns the current data index for the given ID
+        [[nodiscard]]
+        size_type index_of(id_type id) const
+        {
+            return m_ids.index(id);
+        }
+
+        /// Creates a handle pointing to the given stable ID
+        handle_type make_handle(id_type id)
+        {
+            assert(contains(id));
+            return {id, m_ids.generation(id), this};
+        }
+
+        /// Creates a handle from a data index
+        handle_type make_handle_at(size_type idx)
+        {
+            assert(idx < size());
+            return {m_ids.rid(idx), m_ids.generation_at(idx), this};
+        }
+
+        /// Checks if an ID + generation pair still references a live row
+        [[nodiscard]]
+        bool is_valid(id_type id, generation_type generation) const noexcept
+        {
+            return m_ids.is_valid(id, generation, size());
+        }
+
+        /// Returns the generation counter for the given ID
+        [[nodiscard]]
+        generation_type generation(id_type id) const
+        {
+            return m_ids.generation(id);
+        }
+
+        /// Returns the ID that would be assigned to the next inserted row
+        [[nodiscard]]
+        id_type next_id() const
+        {
+            return m_ids.next_id(size());
+        }
+
+        /// Checks whether the ID references a currently live row
+        [[nodiscard]]
+        bool contains(id_type id) const noexcept
+        {
+            return m_ids.contains(id, size());
+        }
+
+    private:
+        void check_at(id_type id) const
+        {
+            if (!contains(id)) {
+#if SIV_EXCEPTIONS
+                throw std::out_of_range("siv::soa_vector::at: invalid id");
+#else
+                assert(false && "siv::soa_vector::at: invalid id");
+#endif
+            }
+        }
+
+        template<typename Column>
+        static void truncate(Column& column, size_type new_size)
+        {
+            while (column.size() > new_size) {
+                column.pop_back();
+            }
+        }
+
+        template<std::size_t... Is>
+        reference row(size_type idx, std::index_sequence<Is...>)
+        {
+            return reference{std::get<Is>(m_columns)[idx]...};
+        }
+
+        template<std::size_t... Is>
+        const_reference row(size_type idx, std::index_sequence<Is...>) const
+        {
+            return const_reference{std::get<Is>(m_columns)[idx]...};
+        }
+
+        /// Appends one value per column, rolling back the columns already grown if one throws
+        template<std::size_t... Is, typename... Args>
+        void emplace_columns(std::index_sequence<Is...>, Args&&... args)
+        {
+#if SIV_EXCEPTIONS
+            size_type grown = 0;
+            try {
+                ((std::get<Is>(m_columns).emplace_back(std::forward<Args>(args)), ++grown), ...);
+            } catch (...) {
+                ((Is < grown ? std::get<Is>(m_columns).pop_back() : void()), ...);
+                throw;
+            }
+#else
+            (std::get<Is>(m_columns).emplace_back(std::forward<Args>(args)), ...);
+#endif
+        }
+
+        columns_type                            m_columns;
+        detail::id_table<Traits, Allocator>     m_ids;
+    };
+
+    /// Erases all rows matching the predicate (C++20-style free function)
+    /// @return The number of rows removed
+    template<typename Allocator, typename Traits, typename... Ts, typename Pred>
+    typename basic_soa_vector<Allocator, Traits, Ts...>::size_type erase_if(basic_soa_vector<Allocator, Traits, Ts...>& v, Pred predicate)
+    {
+        const auto old_size = v.size();
+        v.erase_if(std::move(predicate));
+        return old_size - v.size();
+    }
+
+    /** An append-only vector that many threads can push to at once, without locks, while other
+     *  threads read it. Elements live in segments that double in size and are never moved, so growth
+     *  leaves published elements, and references to them, in place. The ID of an element is its
+     *  position in insertion order, claimed with one atomic increment.
+     *
+     *  Each slot carries a state byte, stored with release ordering once the element is constructed:
+     *  readers only ever see fully constructed elements. Elements cannot be erased one by one, and
+     *  clear() requires that no other thread uses the vector.
+     *
+     * @tparam T         The type of objects to store
+     * @tparam Allocator Allocator for the segments; must be safe to call from several threads
+     */
+    template<typename T, typename Allocator = std::allocator<T>>
+    class concurrent_vector
+    {
+    public:
+        using value_type      = T;
+        using allocator_type  = Allocator;
+        using size_type       = std::size_t;
+        using reference       = T&;
+        using const_reference = const T&;
+        using id_type         = siv::id_type;
+
+        /// log2 of the number of elements in the first segment; segment k holds 2^(k + first_segment_bits)
+        static constexpr unsigned first_segment_bits = 6;
+        static constexpr unsigned segment_count      = 64 - first_segment_bits;
+
+        concurrent_vector() = default;
+
+        explicit concurrent_vector(const Allocator& allocator)
+            : m_allocator(allocator)
+        {}
+
+        // Non-copyable, non-movable: IDs and element addresses handed to other threads refer to this vector
+        concurrent_vector(const concurrent_vector&)            = delete;
+        concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+        ~concurrent_vector()
+        {
+            clear();
+            for (unsigned k{0}; k < segment_count; ++k) {
+                if (T* segment = m_segments[k].load(std::memory_order_relaxed)) {
+                    alloc_traits::deallocate(m_allocator, segment, segment_allocation(k));
+                }
+            }
+        }
+
+        // -- Insertion (any thread, lock-free apart from the allocation of a new segment) --
+
+        [[nodiscard]]
+        id_type push_back(const T& value)
+        {
+            return emplace_back(value);
+        }
+
+        [[nodiscard]]
+        id_type push_back(T&& value)
+        {
+            return emplace_back(std::move(value));
+        }
+
+        /** Constructs an element in the next free slot and publishes it.
+         *  If the constructor throws, the slot stays empty and its ID is never valid.
+         *  @return The ID of the new element
+         */
+        template<typename... Args>
+        [[nodiscard]]
+        id_type emplace_back(Args&&... args)
+        {
+            const id_type id = m_next.fetch_add(1, std::memory_order_relaxed);
+            const location at = locate(id);
+            T* segment = m_segments[at.segment].load(std::memory_order_acquire);
+            if (!segment) {
+                segment = allocate_segment(at.segment);
+            }
+            std::atomic<unsigned char>& state = states(segment, at.segment)[at.offset];
+#if SIV_EXCEPTIONS
+            try {
+#endif
+                alloc_traits::construct(m_allocator, segment + at.offset, std::forward<Args>(args)...);
+#if SIV_EXCEPTIONS
+            } catch (...) {
+                state.store(abandoned, std::memory_order_relaxed);
+                throw;
+            }
+#endif
+            state.store(published, std::memory_order_release);
+            return id;
+        }
+
+        /// Allocates the segments needed to hold `n` elements, so that pushes below `n` never allocate
+        void reserve(size_type n)
+        {
+            for (unsigned k{0}; k < segment_count && first_id(k) < n; ++k) {
+                if (!m_segments[k].load(std::memory_order_acquire)) {
+                    allocate_segment(k);
+                }
+            }
+        }
+
+        // -- Access (any thread) --
+
+        /// Whether `id` refers to an element that is constructed and visible to the calling thread
+        [[nodiscard]]
+        bool contains(id_type id) const noexcept
+        {
+            return find(id) != nullptr;
+        }
+
+        /// The element of `id`, or nullptr if it is not published (yet)
+        [[nodiscard]]
+        T* find(id_type id) noexcept
+        {
+            return const_cast<T*>(std::as_const(*this).find(id));
+        }
+
+        [[nodiscard]]
+        const T* find(id_type id) const noexcept
+        {
+            if (id >= invalid_id - (size_type{1} << first_segment_bits)) {
+                return nullptr;
+            }
+            const location at = locate(id);
+            T* segment = m_segments[at.segment].load(std::memory_order_acquire);
+            if (!segment || states(segment, at.segment)[at.offset].load(std::memory_order_acquire) != published) {
+                return nullptr;
+            }
+            return segment + at.offset;
+        }
+
+        /// Access by ID. The element must be published and visible to the calling thread (see contains()).
+        [[nodiscard]]
+        T& operator[](id_type id) noexcept
+        {
+            assert(contains(id) && "Element not published");
+            const location at = locate(id);
+            return m_segments[at.segment].load(std::memory_order_acquire)[at.offset];
+        }
+
+        [[nodiscard]]
+        const T& operator[](id_type id) const noexcept
+        {
+            assert(contains(id) && "Element not published");
+            const location at = locate(id);
+            return m_segments[at.segment].load(std::memory_order_acquire)[at.offset];
+        }
+
+        /// Access by ID with validation. Throws std::out_of_range (or asserts with -fno-exceptions).
+        [[nodiscard]]
+        T& at(id_type id)
+        {
+            T* element = find(id);
+            if (!element) {
+#if SIV_EXCEPTIONS
+                throw std::out_of_range("siv::concurrent_vector::at: element not published");
+#else
+                assert(false && "siv::concurrent_vector::at: element not published");
+#endif
+            }
+            return *element;
+        }
+
+        [[nodiscard]]
+        const T& at(id_type id) const
+        {
+            return const_cast<concurrent_vector&>(*this).at(id);
+        }
+
+        /** Calls `fn(element)` or `fn(id, element)` on every published element, in ID order.
+         *  Elements published during the walk may or may not be visited.
+         */
+        template<typename Fn>
+        void for_each(Fn&& fn)
+        {
+            walk(*this, fn);
+        }
+
+        template<typename Fn>
+        void for_each(Fn&& fn) const
+        {
+            walk(*this, fn);
+        }
+
+        // -- Capacity --
+
+        /// Number of IDs handed out so far, including elements still being constructed
+        [[nodiscard]]
+        size_type size() const noexcept
+        {
+            return static_cast<size_type>(m_next.load(std::memory_order_acquire));
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        /// Number of slots in the allocated segments
+        [[nodiscard]]
+        size_type capacity() const noexcept
+        {
+            size_type total{0};
+            for (unsigned k{0}; k < segment_count; ++k) {
+                total += m_segments[k].load(std::memory_order_acquire) ? segment_size(k) : 0;
+            }
+            return total;
+        }
+
+        /// Destroys every element and restarts IDs from 0, keeping the segments.
+        /// No other thread may use the vector meanwhile.
+        void clear() noexcept
+        {
+            const size_type n = size();
+            for (unsigned k{0}; k < segment_count && first_id(k) < n; ++k) {
+                T* segment = m_segments[k].load(std::memory_order_relaxed);
+                if (!segment) {
+                    continue;
+                }
+                std::atomic<unsigned char>* slot_states = states(segment, k);
+                const size_type count = std::min(segment_size(k), n - first_id(k));
+                for (size_type i{0}; i < count; ++i) {
+                    if (slot_states[i].load(std::memory_order_relaxed) == published) {
+                        alloc_traits::destroy(m_allocator, segment + i);
+                    }
+                    slot_states[i].store(unset, std::memory_order_relaxed);
+                }
+            }
+            m_next.store(0, std::memory_order_release);
+        }
+
+        [[nodiscard]]
+        allocator_type get_allocator() const noexcept
+        {
+            return m_allocator;
+        }
+
+    private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+
+        /// Slot states. A slot becomes published or abandoned once, and is reset by clear() only.
+        static constexpr unsigned char unset     = 0;
+        static constexpr unsigned char published = 1;
+        static constexpr unsigned char abandoned = 2;
+
+        struct location
+        {
+            unsigned  segment;
+            size_type offset;
+        };
+
+        [[nodiscard]]
+        static location locate(id_type id) noexcept
+        {
+            const uint64_t biased = id + (uint64_t{1} << first_segment_bits);
+            const unsigned bit    = detail::floor_log2(biased);
+            return {bit - first_segment_bits, static_cast<size_type>(biased - (uint64_t{1} << bit))};
+        }
+
+        [[nodiscard]]
+        static constexpr size_type segment_size(unsigned k) noexcept
+        {
+            return size_type{1} << (k + first_segment_bits);
+        }
+
+        /// ID of the first element of segment k
+        [[nodiscard]]
+        static constexpr size_type first_id(unsigned k) noexcept
+        {
+            return segment_size(k) - (size_type{1} << first_segment_bits);
+        }
+
+        /// Segments hold their elements, then one state byte per element, in a single allocation of T
+        [[nodiscard]]
+        static constexpr size_type segment_allocation(unsigned k) noexcept
+        {
+            return segment_size(k) + (segment_size(k) + sizeof(T) - 1) / sizeof(T);
+        }
+
+        [[nodiscard]]
+        static std::atomic<unsigned char>* states(T* segment, unsigned k) noexcept
+        {
+            return reinterpret_cast<std::atomic<unsigned char>*>(segment + segment_size(k));
+        }
+
+        /// Installs a new segment k, or frees it if another thread won the race
+        T* allocate_segment(unsigned k)
+        {
+            T* fresh = alloc_traits::allocate(m_allocator, segment_allocation(k));
+            std::atomic<unsigned char>* slot_states = states(fresh, k);
+            for (size_type i{0}; i < segment_size(k); ++i) {
+                new (slot_states + i) std::atomic<unsigned char>(unset);
+            }
+            T* expected = nullptr;
+            if (!m_segments[k].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+                alloc_traits::deallocate(m_allocator, fresh, segment_allocation(k));
+                return expected;
+            }
+            return fresh;
+        }
+
+        template<typename Self, typename Fn>
+        static void walk(Self& self, Fn& fn)
+        {
+            using element_type = std::conditional_t<std::is_const_v<Self>, const T, T>;
+            const size_type n = self.size();
+            for (unsigned k{0}; k < segment_count && first_id(k) < n; ++k) {
+                T* segment = self.m_segments[k].load(std::memory_order_acquire);
+                if (!segment) {
+                    continue;
+                }
+                std::atomic<unsigned char>* slot_states = states(segment, k);
+                const size_type count = std::min(segment_size(k), n - first_id(k));
+                for (size_type i{0}; i < count; ++i) {
+                    if (slot_states[i].load(std::memory_order_acquire) != published) {
+                        continue;
+                    }
+                    element_type& value = segment[i];
+                    if constexpr (std::is_invocable_v<Fn&, id_type, element_type&>) {
+                        fn(static_cast<id_type>(first_id(k) + i), value);
+                    } else {
+                        fn(value);
+                    }
+                }
+            }
+        }
+
+        // The claim counter has its own cache line: every push writes it
+        alignas(64) std::atomic<id_type>   m_next{0};
+        alignas(64) std::atomic<T*>        m_segments[segment_count]{};
+        Allocator                          m_allocator;
+    };
+
+    /** Independent siv::vector shards behind one ID space, so that several threads can write at once.
+     *  The high ShardBits bits of an ID select the shard and the remaining bits are the ID within the
+     *  shard: a lookup is a shift and a mask on top of the shard's own lookup. Each shard has its own
+     *  mutex, so writers on different shards never wait for each other. push_back() sends each new
+     *  object to the least-loaded shard whose mutex is free; emplace_in() targets one shard, for
+     *  designs where each shard has an owner thread. Iteration walks the shards in order.
+     *
+     * @tparam T         The type of objects to store
+     * @tparam ShardBits log2 of the number of shards
+     * @tparam Allocator, Traits As for siv::vector, used by every shard
+     */
+    template<typename T, unsigned ShardBits = 3, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class sharded_vector
+    {
+    public:
+        using vector_type     = vector<T, Allocator, Traits>;
+        using value_type      = T;
+        using allocator_type  = Allocator;
+        using size_type       = std::size_t;
+        using id_type         = typename vector_type::id_type;
+        using reference       = T&;
+        using const_reference = const T&;
+
+        static_assert(ShardBits >= 1 && ShardBits < Traits::id_bits, "ShardBits must leave bits for the local ID");
+
+        static constexpr size_type shard_count = size_type{1} << ShardBits;
+        static constexpr unsigned  local_bits  = Traits::id_bits - ShardBits;
+        static constexpr id_type   invalid_id  = vector_type::invalid_id;
+
+        sharded_vector()
+            : sharded_vector(Allocator())
+        {}
+
+        explicit sharded_vector(const Allocator& allocator)
+            : m_shards(make_shards(allocator, std::make_index_sequence<shard_count>{}))
+        {}
+
+        // Non-copyable, non-movable, like siv::vector
+        sharded_vector(const sharded_vector&)            = delete;
+        sharded_vector& operator=(const sharded_vector&) = delete;
+
+        // -- IDs --
+
+        /// The shard holding the object of `id`
+        [[nodiscard]]
+        static constexpr size_type shard_of(id_type id) noexcept
+        {
+            return static_cast<size_type>(id >> local_bits);
+        }
+
+        /// The ID of the object within its shard
+        [[nodiscard]]
+        static constexpr id_type local_id(id_type id) noexcept
+        {
+            return static_cast<id_type>(id & detail::low_mask<local_bits>);
+        }
+
+        /// The ID of the object `local` of shard `shard`
+        [[nodiscard]]
+        static constexpr id_type make_id(size_type shard, id_type local) noexcept
+        {
+            return static_cast<id_type>((static_cast<uint64_t>(shard) << local_bits) | local);
+        }
+
+        // -- Modifiers (any thread) --
+
+        [[nodiscard]]
+        id_type push_back(const T& value)
+        {
+            return emplace_back(value);
+        }
+
+        [[nodiscard]]
+        id_type push_back(T&& value)
+        {
+            return emplace_back(std::move(value));
+        }
+
+        /** Constructs an object in the least-loaded shard whose mutex is free, or blocks on the
+         *  least-loaded shard if every mutex is taken.
+         *  @return The ID of the new object
+         */
+        template<typename... Args>
+        [[nodiscard]]
+        id_type emplace_back(Args&&... args)
+        {
+            const size_type s = lock_for_insert();
+            detail::unlock_guard guard(m_shards[s].mutex);
+            return insert(s, std::forward<Args>(args)...);
+        }
+
+        /// Constructs an object in shard `shard`
+        template<typename... Args>
+        [[nodiscard]]
+        id_type emplace_in(size_type shard, Args&&... args)
+        {
+            assert(shard < shard_count && "Shard index out of range");
+            m_shards[shard].mutex.lock();
+            detail::unlock_guard guard(m_shards[shard].mutex);
+            return insert(shard, std::forward<Args>(args)...);
+        }
+
+        /// Removes the object of `id`
+        void erase(id_type id)
+        {
+            with_shard(shard_of(id), [&](vector_type& v) { v.erase(local_id(id)); });
+        }
+
+        /// Removes every object matching the predicate, one shard at a time
+        template<typename Pred>
+        void erase_if(Pred&& predicate)
+        {
+            for (size_type s{0}; s < shard_count; ++s) {
+                with_shard(s, [&](vector_type& v) { v.erase_if(predicate); });
+            }
+        }
+
+        /// Parallel erase_if(): shards are processed concurrently. `predicate` is called from several threads.
+        template<typename Pred>
+        void erase_if(execution::parallel_policy, Pred&& predicate)
+        {
+            parallel_shards([&](vector_type& v) { v.erase_if(predicate); });
+        }
+
+        /// Removes every object, one shard at a time
+        void clear()
+        {
+            for (size_type s{0}; s < shard_count; ++s) {
+                with_shard(s, [](vector_type& v) { v.clear(); });
+            }
+        }
+
+        // -- Access --
+
+        /// Whether `id` references a live object
+        [[nodiscard]]
+        bool contains(id_type id) const
+        {
+            return with_shard(shard_of(id), [&](const vector_type& v) { return v.contains(local_id(id)); });
+        }
+
+        /** Calls `fn(object)` with the shard of `id` locked, if the object is alive.
+         *  @return Whether the object was alive
+         */
+        template<typename Fn>
+        bool visit(id_type id, Fn&& fn)
+        {
+            return with_shard(shard_of(id), [&](vector_type& v) {
+                if (!v.contains(local_id(id))) {
+                    return false;
+                }
+                fn(v[local_id(id)]);
+                return true;
+            });
+        }
+
+        /// Unlocked access by ID: no other thread may write to the shard of `id` meanwhile
+        [[nodiscard]]
+        T& operator[](id_type id) noexcept
+        {
+            return m_shards[shard_of(id)].data[local_id(id)];
+        }
+
+        [[nodiscard]]
+        const T& operator[](id_type id) const noexcept
+        {
+            return m_shards[shard_of(id)].data[local_id(id)];
+        }
+
+        /** Calls `fn(object)` or `fn(id, object)` on every object, shard by shard, each shard locked
+         *  while it is visited.
+         */
+        template<typename Fn>
+        void for_each(Fn&& fn)
+        {
+            for (size_type s{0}; s < shard_count; ++s) {
+                with_shard(s, [&](vector_type& v) { visit_shard(s, v, fn); });
+            }
+        }
+
+        /// Parallel for_each(): shards are visited concurrently. `fn` is called from several threads.
+        template<typename Fn>
+        void for_each(execution::parallel_policy, Fn&& fn)
+        {
+            parallel_shards([&](size_type s, vector_type& v) { visit_shard(s, v, fn); });
+        }
+
+        // -- Shards --
+
+        /// Calls `fn(shard_vector)` with shard `shard` locked and returns its result, for shard-local bulk operations
+        template<typename Fn>
+        decltype(auto) with_shard(size_type shard, Fn&& fn)
+        {
+            assert(shard < shard_count && "Shard index out of range");
+            shard_type& sh = m_shards[shard];
+            sh.mutex.lock();
+            detail::unlock_guard guard(sh.mutex);
+            struct refresh
+            {
+                shard_type& sh;
+                ~refresh() { sh.load.store(sh.data.size(), std::memory_order_relaxed); }
+            } on_exit{sh};
+            return fn(sh.data);
+        }
+
+        /// Calls `fn(const shard_vector)` with shard `shard` locked and returns its result, for shard-local reads
+        template<typename Fn>
+        decltype(auto) with_shard(size_type shard, Fn&& fn) const
+        {
+            assert(shard < shard_count && "Shard index out of range");
+            const shard_type& sh = m_shards[shard];
+            sh.mutex.lock();
+            detail::unlock_guard guard(sh.mutex);
+            return fn(sh.data);
+        }
+
+        /// Unlocked access to shard `shard`, for a thread that owns it or while no other thread writes
+        [[nodiscard]]
+        vector_type& shard(size_type shard) noexcept
+        {
+            assert(shard < shard_count && "Shard index out of range");
+            return m_shards[shard].data;
+        }
+
+        [[nodiscard]]
+        const vector_type& shard(size_type shard) const noexcept
+        {
+            assert(shard < shard_count && "Shard index out of range");
+            return m_shards[shard].data;
+        }
+
+        /// Number of objects in shard `shard`, as of its last modification through this class
+        [[nodiscard]]
+        size_type shard_size(size_type shard) const noexcept
+        {
+            assert(shard < shard_count && "Shard index out of range");
+            return m_shards[shard].load.load(std::memory_order_relaxed);
+        }
+
+        // -- Capacity --
+
+        /// Number of objects; only a snapshot while other threads write
+        [[nodiscard]]
+        size_type size() const noexcept
+        {
+            size_type total{0};
+            for (size_type s{0}; s < shard_count; ++s) {
+                total += shard_size(s);
+            }
+            return total;
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+    private:
+        /// One shard per cache line pair, so that the mutexes of neighbouring shards never share a line
+        struct alignas(64) shard_type
+        {
+            explicit shard_type(const Allocator& allocator)
+                : data(allocator)
+            {}
+
+            mutable detail::mutex   mutex;
+            std::atomic<size_type>  load{0};
+            vector_type             data;
+        };
+
+        template<std::size_t... Is>
+        static std::array<shard_type, shard_count> make_shards(const Allocator& allocator, std::index_sequence<Is...>)
+        {
+            return {{((void)Is, shard_type(allocator))...}};
+        }
+
+        /// Locks and returns the least-loaded shard whose mutex is free, or the least-loaded one
+        size_type lock_for_insert()
+        {
+            size_type least{0};
+            for (size_type s{1}; s < shard_count; ++s) {
+                if (shard_size(s) < shard_size(least)) {
+                    least = s;
+                }
+            }
+            for (size_type i{0}; i < shard_count; ++i) {
+                const size_type s = (least + i) & (shard_count - 1);
+                if (m_shards[s].mutex.try_lock()) {
+                    return s;
+                }
+            }
+            m_shards[least].mutex.lock();
+            return least;
+        }
+
+        /// Inserts into shard `s`, whose mutex the caller holds
+        template<typename... Args>
+        id_type insert(size_type s, Args&&... args)
+        {
+            shard_type& sh = m_shards[s];
+            if (sh.data.next_id() >= static_cast<id_type>(detail::low_mask<local_bits>)) {
+#if SIV_EXCEPTIONS
+                throw std::length_error("siv::sharded_vector: shard ID space exhausted");
+#else
+                assert(false && "siv::sharded_vector: shard ID space exhausted");
+#endif
+            }
+            const id_type local = sh.data.emplace_back(std::forward<Args>(args)...);
+            sh.load.store(sh.data.size(), std::memory_order_relaxed);
+            return make_id(s, local);
+        }
+
+        template<typename Fn>
+        static void visit_shard(size_type s, vector_type& v, Fn& fn)
+        {
+            if constexpr (std::is_invocable_v<Fn&, id_type, T&>) {
+                v.for_each([&](id_type local, T& value) { fn(make_id(s, local), value); });
+            } else {
+                v.for_each(fn);
+            }
+        }
+
+        /// Runs fn(shard, vector) or fn(vector) on every shard, each locked, spread over the hardware threads
+        template<typename Fn>
+        void parallel_shards(Fn&& fn)
+        {
+            const size_type tasks = std::min(shard_count, detail::parallel_chunks(size()));
+            detail::parallel_tasks(tasks, [&](size_type task) {
+                for (size_type s = task; s < shard_count; s += tasks) {
+                    with_shard(s, [&](vector_type& v) {
+                        if constexpr (std::is_invocable_v<Fn&, size_type, vector_type&>) {
+                            fn(s, v);
+                        } else {
+                            fn(v);
+                        }
+                    });
+                }
+            });
+        }
+
+        std::array<shard_type, shard_count> m_shards;
+    };
+
+    /** A siv::vector that other threads can read without locks while its owner thread modifies it.
+     *  The owner wraps every modification in write(), which makes a sequence counter odd for its
+     *  duration. Readers copy what they look up, then check that the counter did not move, and
+     *  retry otherwise: a read never blocks the writer, and the writer never waits for readers.
+     *
+     *  Buffers that growth or shrink_to_fit() replace are not freed but retired, so that a reader
+     *  holding an old address still reads mapped memory. The owner frees them with reclaim() once
+     *  no read is in flight, e.g. at a frame boundary. Until then they are all kept: every growth
+     *  and every shrink_to_fit() adds to them, without bound (see retired_bytes()). Elements are
+     *  copied out, so T must be trivially copyable.
+     *
+     * @tparam T, Allocator, Traits As for siv::vector; the storage must be contiguous and the
+     *                              erase policy swap_and_pop
+     */
+    template<typename T, typename Allocator, typename Traits>
+    class optimistic_vector
+    {
+    public:
+        using allocator_type  = detail::retiring_allocator<T, Allocator>;
+        using vector_type     = vector<T, allocator_type, Traits>;
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using id_type         = typename vector_type::id_type;
+        using generation_type = typename vector_type::generation_type;
+
+        static_assert(std::is_trivially_copyable_v<T>, "Optimistic readers copy elements: T must be trivially copyable");
+        static_assert(Traits::erase_mode == erase_policy::swap_and_pop, "Tombstones are not supported");
+        static_assert(detail::has_data<typename vector_type::storage_type>::value
+                          && detail::has_data<typename vector_type::id_table_type::index_storage>::value
+                          && detail::has_data<typename vector_type::id_table_type::metadata_storage>::value,
+                      "Optimistic readers need contiguous storage");
+
+        optimistic_vector()
+            : optimistic_vector(Allocator())
+        {}
+
+        explicit optimistic_vector(const Allocator& allocator)
+            : m_memory(allocator)
+            , m_vector(allocator_type(&m_memory))
+        {
+            m_spare = new_layout();
+            publish();
+        }
+
+        // Non-copyable, non-movable: readers hold its address
+        optimistic_vector(const optimistic_vector&)            = delete;
+        optimistic_vector& operator=(const optimistic_vector&) = delete;
+
+        ~optimistic_vector()
+        {
+            // Freed with the vector's buffers once the vector is destroyed
+            m_memory.retire(const_cast<layout*>(m_layout.load(std::memory_order_relaxed)));
+            if (m_spare) {
+                m_memory.retire(m_spare);
+            }
+        }
+
+        // -- Writer (owner thread) --
+
+        /** Calls `fn(vector)` as one write: readers overlapping it retry. Returns what `fn` returns.
+         *  Every modification of the vector must go through write().
+         */
+        template<typename Fn>
+        decltype(auto) write(Fn&& fn)
+        {
+            if (!m_spare) {
+                m_spare = new_layout();
+            }
+            const uint64_t version = m_version.load(std::memory_order_relaxed);
+            detail::seqlock_begin_write(m_version);
+            struct end_write
+            {
+                optimistic_vector& self;
+                uint64_t           version;
+                ~end_write()
+                {
+                    self.publish();
+                    self.m_version.store(version + 2, std::memory_order_release);
+                }
+            } guard{*this, version};
+            return fn(m_vector);
+        }
+
+        [[nodiscard]]
+        id_type push_back(const T& value)
+        {
+            return write([&](vector_type& v) { return v.push_back(value); });
+        }
+
+        template<typename... Args>
+        [[nodiscard]]
+        id_type emplace_back(Args&&... args)
+        {
+            return write([&](vector_type& v) { return v.emplace_back(std::forward<Args>(args)...); });
+        }
+
+        void erase(id_type id)
+        {
+            write([&](vector_type& v) { v.erase(id); });
+        }
+
+        template<typename Pred>
+        void erase_if(Pred&& predicate)
+        {
+            write([&](vector_type& v) { v.erase_if(predicate); });
+        }
+
+        void clear()
+        {
+            write([](vector_type& v) { v.clear(); });
+        }
+
+        /// The vector, for reads from the owner thread, which need no validation
+        [[nodiscard]]
+        const vector_type& get() const noexcept
+        {
+            return m_vector;
+        }
+
+        /// Frees the retired buffers. No read may be in flight on any thread.
+        void reclaim() noexcept
+        {
+            m_memory.reclaim();
+        }
+
+        /// Bytes held by retired buffers until the next reclaim()
+        [[nodiscard]]
+        size_type retired_bytes() const noexcept
+        {
+            return m_memory.retired_bytes();
+        }
+
+        // -- Readers (any thread) --
+
+        /** Copies the object of `id` into `out` if it is alive.
+         *  @return Whether it was; `out` is left untouched otherwise
+         */
+        bool load(id_type id, T& out) const noexcept
+        {
+            return read<false>(id, generation_type{}, &out);
+        }
+
+        /// Copies the object of `id` if it is alive
+        [[nodiscard]]
+        std::optional<T> load(id_type id) const
+        {
+            std::optional<T> out(std::in_place);
+            if (!load(id, *out)) {
+                out.reset();
+            }
+            return out;
+        }
+
+        /// Copies the object of `id` into `out` if it is alive and still has `generation`
+        bool load(id_type id, generation_type generation, T& out) const noexcept
+        {
+            return read<true>(id, generation, &out);
+        }
+
+        [[nodiscard]]
+        bool contains(id_type id) const noexcept
+        {
+            return read<false>(id, generation_type{}, nullptr);
+        }
+
+        [[nodiscard]]
+        bool is_valid(id_type id, generation_type generation) const noexcept
+        {
+            return read<true>(id, generation, nullptr);
+        }
+
+        /// Sequence counter: odd while a write is in progress, advanced by 2 per write
+        [[nodiscard]]
+        uint64_t version() const noexcept
+        {
+            return m_version.load(std::memory_order_acquire);
+        }
+
+    private:
+        using id_table_type = typename vector_type::id_table_type;
+        using index_entry   = typename id_table_type::index_entry;
+        using metadata      = typename id_table_type::metadata;
+
+        /// Addresses and capacities of the buffers, immutable once published
+        struct layout
+        {
+            const T*           data;
+            size_type          data_capacity;
+            const index_entry* indexes;
+            size_type          index_capacity;
+            const metadata*    metadata_entries;
+            size_type          metadata_capacity;
+        };
+
+        [[nodiscard]]
+        layout* new_layout()
+        {
+            return ::new (m_memory.allocate(sizeof(layout))) layout{};
+        }
+
+        /// Publishes the current sizes, and the buffers if one moved. Runs while the counter is odd.
+        void publish() noexcept
+        {
+            const id_table_type& ids = m_vector.m_ids;
+            const layout current{m_vector.data(), m_vector.m_data.capacity(),
+                                 ids.index_data(), ids.index_capacity(),
+                                 ids.metadata_data(), ids.metadata_capacity()};
+            const layout* published = m_layout.load(std::memory_order_relaxed);
+            if (!published || std::memcmp(published, &current, sizeof(layout)) != 0) {
+                *m_spare = current;
+                m_layout.store(m_spare, std::memory_order_release);
+                m_spare = nullptr;
+                if (published) {
+                    m_memory.retire(const_cast<layout*>(published));
+                }
+            }
+            m_size.store(m_vector.m_data.size(), std::memory_order_relaxed);
+            m_index_count.store(ids.index_count(), std::memory_order_relaxed);
+        }
+
+        /// Optimistic lookup: copies, then validates against the sequence counter, until no write overlapped
+        template<bool CheckGeneration>
+        bool read(id_type id, generation_type generation, T* out) const noexcept
+        {
+            alignas(T) unsigned char value[sizeof(T)];
+            for (unsigned spins{0};; detail::spin_wait(spins)) {
+                const uint64_t before = m_version.load(std::memory_order_acquire);
+                if (before & 1) {
+                    continue;
+                }
+                const layout& l    = *m_layout.load(std::memory_order_acquire);
+                const size_type n  = std::min({m_size.load(std::memory_order_relaxed), l.data_capacity, l.metadata_capacity});
+                const size_type ni = std::min(m_index_count.load(std::memory_order_relaxed), l.index_capacity);
+                bool found = false;
+                if (id < ni) {
+                    index_entry entry;
+                    detail::racy_copy(&entry, l.indexes + id, sizeof(entry));
+                    const size_type pos = id_table_type::entry_position(entry);
+                    if (pos < n) {
+                        found = true;
+                        if constexpr (CheckGeneration) {
+                            if constexpr (id_table_type::colocated) {
+                                found = entry.generation() == generation;
+                            } else {
+                                metadata meta;
+                                detail::racy_copy(&meta, l.metadata_entries + pos, sizeof(meta));
+                                found = meta.generation() == generation;
+                            }
+                        }
+                        if (found && out) {
+                            detail::racy_copy(value, l.data + pos, sizeof(T));
+                        }
+                    }
+                }
+                if (detail::seqlock_unchanged(m_version, before)) {
+                    if (found && out) {
+                        std::memcpy(static_cast<void*>(out), value, sizeof(T));
+                    }
+                    return found;
+                }
+            }
+        }
+
+        // The counter and the published state share a cache line that only the writer stores to.
+        // Mutable for the read-modify-write with which readers validate under ThreadSanitizer.
+        alignas(64) mutable std::atomic<uint64_t> m_version{0};
+        std::atomic<const layout*>                m_layout{nullptr};
+        std::atomic<size_type>                    m_size{0};
+        std::atomic<size_type>                    m_index_count{0};
+        // Declared before the vector, so that it still takes the vector's buffers when the vector is destroyed
+        detail::retired_memory<Allocator>         m_memory;
+        vector_type                               m_vector;
+        layout*                                   m_spare{nullptr};
+    };
+
+    /** A siv::vector written by one owner thread and read by up to MaxReaders other threads through
+     *  immutable snapshots. The owner modifies a private vector, then publish() copies its elements
+     *  and ID tables into a new snapshot and swaps it in with one atomic store. A reader pins the
+     *  current snapshot: lookups and iteration then see one consistent state, never retry, and never
+     *  wait for the writer, however it grows or reorders the vector meanwhile.
+     *
+     *  Replaced snapshots are freed by epoch-based reclamation: each publish() advances a global
+     *  epoch, a pin records the epoch it started in, and a snapshot replaced in epoch e is freed by
+     *  the owner once every pinned reader started after e. A reader pinned for long only delays the
+     *  reclamation. publish() copies the whole live state: batch the changes of a frame into one.
+     *
+     * @tparam T, Allocator, Traits As for siv::vector; T must be copy-constructible, the erase policy
+     *                              swap_and_pop and the ID tables contiguous
+     * @tparam MaxReaders           Number of reader threads that can be registered at once
+     */
+    template<typename T, std::size_t MaxReaders, typename Allocator, typename Traits>
+    class epoch_vector
+    {
+        struct snapshot;
+        struct reader_slot;
+
+    public:
+        using vector_type     = vector<T, Allocator, Traits>;
+        using value_type      = T;
+        using allocator_type  = Allocator;
+        using size_type       = std::size_t;
+        using const_reference = const T&;
+        using const_iterator  = const T*;
+        using id_type         = typename vector_type::id_type;
+        using generation_type = typename vector_type::generation_type;
+
+        static_assert(MaxReaders > 0, "At least one reader is required");
+        static_assert(std::is_copy_constructible_v<T>, "Snapshots copy elements: T must be copy-constructible");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+        static_assert(Traits::erase_mode == erase_policy::swap_and_pop, "Tombstones are not supported");
+        static_assert(detail::has_data<typename vector_type::id_table_type::index_storage>::value
+                          && detail::has_data<typename vector_type::id_table_type::metadata_storage>::value,
+                      "Snapshots copy the ID tables: they must be contiguous");
+
+        static constexpr size_type max_readers = MaxReaders;
+
+        /** A pinned snapshot. Everything it returns stays valid and unchanged until it is destroyed.
+         *  Obtained from reader::read(); lives on the reader's thread.
+         */
+        class view
+        {
+        public:
+            view(const view&)            = delete;
+            view& operator=(const view&) = delete;
+
+            ~view()
+            {
+                m_slot.store(idle, std::memory_order_release);
+            }
+
+            /// The object of `id`, or nullptr if it was not alive when the snapshot was published
+            [[nodiscard]]
+            const T* find(id_type id) const noexcept
+            {
+                const size_type pos = position(id);
+                return pos < m_snapshot->size ? m_snapshot->data + pos : nullptr;
+            }
+
+            [[nodiscard]]
+            bool contains(id_type id) const noexcept
+            {
+                return position(id) < m_snapshot->size;
+            }
+
+            /// Whether `id` was alive with `generation` when the snapshot was published
+            [[nodiscard]]
+            bool is_valid(id_type id, generation_type generation) const noexcept
+            {
+                const size_type pos = position(id);
+                if (pos >= m_snapshot->size) {
+                    return false;
+                }
+                if constexpr (id_table_type::colocated) {
+                    return m_snapshot->indexes[id].generation() == generation;
+                } else {
+                    return m_snapshot->metadata_entries[pos].generation() == generation;
+                }
+            }
+
+            [[nodiscard]]
+            const T& operator[](id_type id) const noexcept
+            {
+                assert(contains(id) && "Object not alive in this snapshot");
+                return m_snapshot->data[position(id)];
+            }
+
+            /// ID of the object at position `pos` of the snapshot
+            [[nodiscard]]
+            id_type get_id_at(size_type pos) const noexcept
+            {
+                assert(pos < m_snapshot->size && "Position out of range");
+                return m_snapshot->metadata_entries[pos].id();
+            }
+
+            /// Calls `fn(object)` or `fn(id, object)` on every object of the snapshot, in storage order
+            template<typename Fn>
+            void for_each(Fn&& fn) const
+            {
+                for (size_type pos{0}; pos < m_snapshot->size; ++pos) {
+                    if constexpr (std::is_invocable_v<Fn&, id_type, const T&>) {
+                        fn(static_cast<id_type>(m_snapshot->metadata_entries[pos].id()), m_snapshot->data[pos]);
+                    } else {
+                        fn(m_snapshot->data[pos]);
+                    }
+                }
+            }
+
+            [[nodiscard]] const T*       data()  const noexcept { return m_snapshot->data;                     }
+            [[nodiscard]] const_iterator begin() const noexcept { return m_snapshot->data;                     }
+            [[nodiscard]] const_iterator end()   const noexcept { return m_snapshot->data + m_snapshot->size; }
+            [[nodiscard]] size_type      size()  const noexcept { return m_snapshot->size;                     }
+            [[nodiscard]] bool           empty() const noexcept { return m_snapshot->size == 0;                }
+
+            /// Number of publish() calls that preceded this snapshot
+            [[nodiscard]]
+            uint64_t version() const noexcept
+            {
+                return m_snapshot->version;
+            }
+
+        private:
+            friend class epoch_vector;
+
+            view(std::atomic<uint64_t>& slot, const snapshot* s) noexcept
+                : m_slot{slot}
+                , m_snapshot{s}
+            {}
+
+            [[nodiscard]]
+            size_type position(id_type id) const noexcept
+            {
+                return id < m_snapshot->index_count ? id_table_type::entry_position(m_snapshot->indexes[id])
+                                                    : m_snapshot->size;
+            }
+
+            std::atomic<uint64_t>& m_slot;
+            const snapshot*        m_snapshot;
+        };
+
+        /** The registration of one reader thread: holds one of the MaxReaders slots until destroyed.
+         *  Registering takes a compare-and-swap per occupied slot; read() is wait-free.
+         */
+        class reader
+        {
+        public:
+            /// Takes a free slot. Throws std::length_error (or asserts with -fno-exceptions) if all are taken.
+            explicit reader(const epoch_vector& owner)
+                : m_owner{owner}
+                , m_slot{owner.acquire_slot()}
+            {}
+
+            reader(const reader&)            = delete;
+            reader& operator=(const reader&) = delete;
+
+            ~reader()
+            {
+                assert(m_slot.epoch.load(std::memory_order_relaxed) == idle && "A view of this reader is still alive");
+                m_slot.taken.store(false, std::memory_order_release);
+            }
+
+            /** Pins the current snapshot until the returned view is destroyed.
+             *  A reader holds at most one view at a time.
+             */
+            [[nodiscard]]
+            view read() const noexcept
+            {
+                assert(m_slot.epoch.load(std::memory_order_relaxed) == idle && "A view of this reader is still alive");
+                // The pin must be visible before the snapshot is loaded: whatever snapshot this
+                // loads is replaced in this epoch or later, and not freed while the pin holds
+                m_slot.epoch.store(m_owner.m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+                return view(m_slot.epoch, m_owner.m_current.load(std::memory_order_seq_cst));
+            }
+
+        private:
+            const epoch_vector& m_owner;
+            reader_slot&        m_slot;
+        };
+
+        epoch_vector()
+            : epoch_vector(Allocator())
+        {}
+
+        explicit epoch_vector(const Allocator& allocator)
+            : m_vector(allocator)
+            , m_allocator(allocator)
+        {
+            m_current.store(make_snapshot(), std::memory_order_relaxed);
+        }
+
+        // Non-copyable, non-movable: readers hold its address
+        epoch_vector(const epoch_vector&)            = delete;
+        epoch_vector& operator=(const epoch_vector&) = delete;
+
+        ~epoch_vector()
+        {
+            for ([[maybe_unused]] const reader_slot& slot : m_slots) {
+                assert(!slot.taken.load(std::memory_order_relaxed) && "A reader outlives the vector");
+            }
+            free_snapshot(m_current.load(std::memory_order_relaxed));
+            free_retired(m_retired);
+            if (m_spare) {
+                deallocate(m_spare, m_spare->units);
+            }
+        }
+
+        // -- Writer (owner thread) --
+
+        /** Calls `fn(vector)` on the private vector and returns what it returns.
+         *  Readers see the changes at the next publish().
+         */
+        template<typename Fn>
+        decltype(auto) write(Fn&& fn)
+        {
+            m_dirty = true;
+            return fn(m_vector);
+        }
+
+        [[nodiscard]]
+        id_type push_back(const T& value)
+        {
+            return write([&](vector_type& v) { return v.push_back(value); });
+        }
+
+        template<typename... Args>
+        [[nodiscard]]
+        id_type emplace_back(Args&&... args)
+        {
+            return write([&](vector_type& v) { return v.emplace_back(std::forward<Args>(args)...); });
+        }
+
+        void erase(id_type id)
+        {
+            write([&](vector_type& v) { v.erase(id); });
+        }
+
+        template<typename Pred>
+        void erase_if(Pred&& predicate)
+        {
+            write([&](vector_type& v) { v.erase_if(predicate); });
+        }
+
+        void clear()
+        {
+            write([](vector_type& v) { v.clear(); });
+        }
+
+        /** Makes the changes since the last publish() visible to new views, and frees the snapshots
+         *  no reader can still see. Copies the live elements and ID tables when anything changed.
+         *  If the copy throws, readers keep the previous snapshot.
          */
-        reference at(id_type id)
+        void publish()
         {
-            check_at(id);
-            return m_data[m_indexes[id]];
+            if (m_dirty) {
+                snapshot* next = make_snapshot();
+                snapshot* old  = m_current.load(std::memory_order_relaxed);
+                m_current.store(next, std::memory_order_seq_cst);
+                const uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+                old->retired_epoch = epoch;
+                old->next          = m_retired;
+                m_retired          = old;
+                ++m_retired_count;
+                m_epoch.store(epoch + 1, std::memory_order_seq_cst);
+                m_dirty = false;
+            }
+            reclaim();
         }
 
-        const_reference at(id_type id) const
+        /// Frees the replaced snapshots that no pinned reader can still see
+        void reclaim() noexcept
         {
-            check_at(id);
-            return m_data[m_indexes[id]];
+            uint64_t oldest = idle;
+            for (const reader_slot& slot : m_slots) {
+                oldest = std::min(oldest, slot.epoch.load(std::memory_order_seq_cst));
+            }
+            // The list runs from the newest retirement to the oldest
+            snapshot** link = &m_retired;
+            while (*link && (*link)->retired_epoch >= oldest) {
+                link = &(*link)->next;
+            }
+            free_retired(*link);
+            *link = nullptr;
         }
 
-        /// Access element by stable ID (no bounds checking)
-        reference operator[](id_type id)
+        /// Number of replaced snapshots that are not freed yet
+        [[nodiscard]]
+        size_type retired_count() const noexcept
         {
-            return m_data[m_indexes[id]];
+            return m_retired_count;
         }
 
-        const_reference operator[](id_type id) const
+        /// The private vector, for reads from the owner thread, which see unpublished changes
+        [[nodiscard]]
+        const vector_type& get() const noexcept
         {
-            return m_data[m_indexes[id]];
+            return m_vector;
         }
 
-        reference front()
+        /// Number of publish() calls that produced a snapshot
+        [[nodiscard]]
+        uint64_t version() const noexcept
         {
-            return m_data.front();
+            return m_current.load(std::memory_order_acquire)->version;
         }
 
-        const_reference front() const
+        [[nodiscard]]
+        allocator_type get_allocator() const noexcept
         {
-            return m_data.front();
+            return m_allocator;
         }
 
-        reference back()
+    private:
+        using id_table_type = typename vector_type::id_table_type;
+        using index_entry   = typename id_table_type::index_entry;
+        using metadata      = typename id_table_type::metadata;
+
+        /// Slot epoch of a reader that holds no view; also the epoch of an unregistered slot
+        static constexpr uint64_t idle = (std::numeric_limits<uint64_t>::max)();
+
+        struct alignas(std::max_align_t) unit
+        {
+            unsigned char bytes[alignof(std::max_align_t)];
+        };
+
+        using unit_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<unit>;
+        using unit_traits    = std::allocator_traits<unit_allocator>;
+
+        /// Header of a snapshot, followed in the same allocation by its elements, indexes and metadata
+        struct snapshot
+        {
+            const T*           data;
+            const index_entry* indexes;
+            const metadata*    metadata_entries;
+            size_type          size;
+            size_type          index_count;
+            uint64_t           version;
+            size_type          units;
+            // Owner-thread bookkeeping once the snapshot is replaced
+            snapshot*          next;
+            uint64_t           retired_epoch;
+        };
+
+        // Each slot has its own cache line: its reader writes it on every pin
+        struct alignas(64) reader_slot
+        {
+            std::atomic<uint64_t> epoch{idle};
+            std::atomic<bool>     taken{false};
+        };
+
+        [[nodiscard]]
+        static constexpr size_type align_up(size_type bytes, size_type alignment) noexcept
         {
-            return m_data.back();
+            return (bytes + alignment - 1) / alignment * alignment;
         }
 
-        const_reference back() const
+        reader_slot& acquire_slot() const
         {
-            return m_data.back();
+            for (reader_slot& slot : m_slots) {
+                bool expected = false;
+                if (!slot.taken.load(std::memory_order_relaxed)
+                    && slot.taken.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return slot;
+                }
+            }
+#if SIV_EXCEPTIONS
+            throw std::length_error("siv::epoch_vector: too many readers");
+#else
+            assert(false && "siv::epoch_vector: too many readers");
+            std::abort();
+#endif
         }
 
-        pointer data() noexcept
+        /// Copies the private vector into a new snapshot, reusing the spare allocation if it fits
+        [[nodiscard]]
+        snapshot* make_snapshot()
         {
-            return m_data.data();
+            const id_table_type& ids = m_vector.m_ids;
+            const size_type n  = m_vector.size();
+            const size_type ni = ids.index_count();
+            const size_type data_offset     = align_up(sizeof(snapshot), alignof(T));
+            const size_type index_offset    = align_up(data_offset + n * sizeof(T), alignof(index_entry));
+            const size_type metadata_offset = align_up(index_offset + ni * sizeof(index_entry), alignof(metadata));
+            const size_type units = (metadata_offset + n * sizeof(metadata) + sizeof(unit) - 1) / sizeof(unit);
+
+            unit* block = nullptr;
+            size_type allocated = units;
+            if (m_spare && m_spare->units >= units) {
+                block     = reinterpret_cast<unit*>(m_spare);
+                allocated = m_spare->units;
+                m_spare   = nullptr;
+            } else {
+                block = unit_traits::allocate(m_allocator, units);
+            }
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(block);
+            T* data = reinterpret_cast<T*>(bytes + data_offset);
+#if SIV_EXCEPTIONS
+            try {
+#endif
+                if constexpr (detail::has_data<typename vector_type::storage_type>::value) {
+                    std::uninitialized_copy_n(m_vector.data(), n, data);
+                } else {
+                    std::uninitialized_copy(m_vector.begin(), m_vector.end(), data);
+                }
+#if SIV_EXCEPTIONS
+            } catch (...) {
+                unit_traits::deallocate(m_allocator, block, allocated);
+                throw;
+            }
+#endif
+            auto* indexes  = reinterpret_cast<index_entry*>(bytes + index_offset);
+            auto* metadata_entries = reinterpret_cast<metadata*>(bytes + metadata_offset);
+            std::uninitialized_copy_n(ids.index_data(), ni, indexes);
+            std::uninitialized_copy_n(ids.metadata_data(), n, metadata_entries);
+            return ::new (static_cast<void*>(block)) snapshot{data, indexes, metadata_entries, n, ni,
+                                                              m_published++, allocated, nullptr, 0};
         }
 
-        const_pointer data() const noexcept
+        /// Destroys the elements of a snapshot and keeps the largest block as the spare
+        void free_snapshot(snapshot* s) noexcept
         {
-            return m_data.data();
+            std::destroy_n(const_cast<T*>(s->data), s->size);
+            if (!m_spare || m_spare->units < s->units) {
+                std::swap(s, m_spare);
+            }
+            if (s) {
+                deallocate(s, s->units);
+            }
         }
 
-        // -- Iterators --
+        void free_retired(snapshot* s) noexcept
+        {
+            while (s) {
+                snapshot* next = s->next;
+                free_snapshot(s);
+                --m_retired_count;
+                s = next;
+            }
+        }
 
-        iterator       begin()        noexcept { return m_data.begin();   }
-        iterator       end()          noexcept { return m_data.end();     }
-        const_iterator begin()  const noexcept { return m_data.begin();   }
-        const_iterator end()    const noexcept { return m_data.end();     }
-        const_iterator cbegin() const noexcept { return m_data.cbegin();  }
-        const_iterator cend()   const noexcept { return m_data.cend();    }
+        void deallocate(snapshot* s, size_type units) noexcept
+        {
+            unit_traits::deallocate(m_allocator, reinterpret_cast<unit*>(s), units);
+        }
 
-        reverse_iterator       rbegin()        noexcept { return m_data.rbegin();  }
-        reverse_iterator       rend()          noexcept { return m_data.rend();    }
-        const_reverse_iterator rbegin()  const noexcept { return m_data.rbegin();  }
-        const_reverse_iterator rend()    const noexcept { return m_data.rend();    }
-        const_reverse_iterator crbegin() const noexcept { return m_data.crbegin(); }
-        const_reverse_iterator crend()   const noexcept { return m_data.crend();   }
+        // Loaded by every pin; only the writer stores to this line
+        alignas(64) std::atomic<uint64_t>         m_epoch{1};
+        std::atomic<snapshot*>                    m_current{nullptr};
+        mutable std::array<reader_slot, MaxReaders> m_slots{};
+        vector_type                               m_vector;
+        unit_allocator                            m_allocator;
+        snapshot*                                 m_retired{nullptr};
+        snapshot*                                 m_spare{nullptr};
+        size_type                                 m_retired_count{0};
+        uint64_t                                  m_published{0};
+        bool                                      m_dirty{false};
+    };
 
-        // -- Capacity --
+    /** Two data buffers sharing one ID space, for simulations that read the state of frame N while
+     *  writing frame N+1. front() is the read-only state of the last frame, back() the writable
+     *  state of the next one: both hold one object per live ID, at the same position.
+     *  swap_buffers() exchanges them by flipping an index, without copying objects.
+     *
+     *  Inserts and erases during a frame are deferred: an insert gets its ID at once, but the ID
+     *  only becomes live, in both buffers, at the next swap_buffers(), and an erased object stays
+     *  live until then. The ID tables thus change once per swap, and front() and back() never see
+     *  each other's positions move. After a swap, back() holds the objects of two frames ago, or
+     *  the inserted value for new IDs: overwrite them, or call copy_front_to_back() first.
+     *
+     * @tparam T, Allocator, Traits As for siv::vector; the erase policy must be swap_and_pop and
+     *                              the traits must not attach an observer
+     */
+    template<typename T, typename Allocator = std::allocator<T>, typename Traits = default_traits>
+    class double_buffered_vector
+    {
+        using id_table_type = detail::id_table<Traits, Allocator>;
+        using storage_type  = typename Traits::template storage<T, Allocator>;
 
-        [[nodiscard]] bool      empty()    const noexcept { return m_data.empty();    }
-        [[nodiscard]] size_type size()     const noexcept { return m_data.size();     }
-        [[nodiscard]] size_type max_size() const noexcept { return m_data.max_size(); }
-        [[nodiscard]] size_type capacity() const noexcept { return m_data.capacity(); }
+        static constexpr bool relocates = detail::relocates<storage_type>::value;
 
-        void reserve(size_type new_cap)
+    public:
+        using value_type      = T;
+        using allocator_type  = Allocator;
+        using size_type       = std::size_t;
+        using id_type         = typename Traits::id_type;
+        using generation_type = typename Traits::generation_type;
+
+        static_assert(Traits::erase_mode == erase_policy::swap_and_pop, "Tombstones are not supported");
+        static_assert(std::is_same_v<typename Traits::observer, no_observer>, "Observers are not supported");
+        static_assert(std::is_copy_constructible_v<T>, "Inserted objects are copied into both buffers");
+
+        /** One buffer seen through the shared ID table: the live objects, by ID or by position.
+         *  Invalidated by the next swap_buffers(). An insert can move the objects of the back
+         *  buffer, like growth moves those of a siv::vector.
+         */
+        template<bool Const>
+        class buffer_view
         {
-            m_data.reserve(new_cap);
-            m_metadata.reserve(new_cap);
-            m_indexes.reserve(new_cap);
-        }
+        public:
+            using element_type = std::conditional_t<Const, const T, T>;
+            using reference    = element_type&;
+            using iterator     = std::conditional_t<Const, typename storage_type::const_iterator,
+                                                           typename storage_type::iterator>;
 
-        /// Shrinks the data vector. Index/metadata vectors are not shrunk (needed for ID recycling).
-        void shrink_to_fit()
+            /// The object of `id`, or nullptr if the ID is not live
+            [[nodiscard]]
+            element_type* find(id_type id) const noexcept
+            {
+                return contains(id) ? &(*m_data)[m_ids->index(id)] : nullptr;
+            }
+
+            [[nodiscard]]
+            bool contains(id_type id) const noexcept
+            {
+                return m_ids->contains(id, m_size);
+            }
+
+            [[nodiscard]]
+            reference operator[](id_type id) const noexcept
+            {
+                assert(contains(id) && "Object not live");
+                return (*m_data)[m_ids->index(id)];
+            }
+
+            /// Access by ID with validation. Throws std::out_of_range (or asserts with -fno-exceptions).
+            [[nodiscard]]
+            reference at(id_type id) const
+            {
+                if (!contains(id)) {
+#if SIV_EXCEPTIONS
+                    throw std::out_of_range("siv::double_buffered_vector::at: invalid id");
+#else
+                    assert(false && "siv::double_buffered_vector::at: invalid id");
+#endif
+                }
+                return (*m_data)[m_ids->index(id)];
+            }
+
+            /// The object at position `pos`, the same position in both buffers
+            [[nodiscard]]
+            reference at_position(size_type pos) const noexcept
+            {
+                assert(pos < m_size && "Position out of range");
+                return (*m_data)[pos];
+            }
+
+            /// ID of the object at position `pos`
+            [[nodiscard]]
+            id_type get_id_at(size_type pos) const noexcept
+            {
+                assert(pos < m_size && "Position out of range");
+                return m_ids->rid(pos);
+            }
+
+            /// Calls `fn(object)` or `fn(id, object)` on every live object, in storage order
+            template<typename Fn>
+            void for_each(Fn&& fn) const
+            {
+                for (size_type pos{0}; pos < m_size; ++pos) {
+                    if constexpr (std::is_invocable_v<Fn&, id_type, reference>) {
+                        fn(m_ids->rid(pos), (*m_data)[pos]);
+                    } else {
+                        fn((*m_data)[pos]);
+                    }
+                }
+            }
+
+            [[nodiscard]] iterator  begin() const noexcept { return m_data->begin();                                              }
+            [[nodiscard]] iterator  end()   const noexcept { return m_data->begin() + static_cast<std::ptrdiff_t>(m_size); }
+            [[nodiscard]] size_type size()  const noexcept { return m_size;                                                   }
+            [[nodiscard]] bool      empty() const noexcept { return m_size == 0;                                              }
+
+        private:
+            friend class double_buffered_vector;
+
+            using storage_pointer = std::conditional_t<Const, const storage_type*, storage_type*>;
+
+            buffer_view(const id_table_type& ids, storage_pointer data, size_type size) noexcept
+                : m_ids{&ids}
+                , m_data{data}
+                , m_size{size}
+            {}
+
+            const id_table_type* m_ids;
+            storage_pointer      m_data;
+            size_type            m_size;
+        };
+
+        using front_view = buffer_view<true>;
+        using back_view  = buffer_view<false>;
+
+        double_buffered_vector()
+            : double_buffered_vector(Allocator())
+        {}
+
+        explicit double_buffered_vector(const Allocator& allocator)
+            : m_buffers{storage_type(allocator), storage_type(allocator)}
+            , m_ids(allocator)
+            , m_pending_ids(pending_allocator_type(allocator))
+            , m_erased(id_allocator_type(allocator))
+        {}
+
+        // Non-copyable, non-movable, like siv::vector
+        double_buffered_vector(const double_buffered_vector&)            = delete;
+        double_buffered_vector& operator=(const double_buffered_vector&) = delete;
+
+        // -- Buffers --
+
+        /// The state of the last frame, read-only
+        [[nodiscard]]
+        front_view front() const noexcept
         {
-            m_data.shrink_to_fit();
+            return front_view(m_ids, &m_buffers[m_front], m_size);
         }
 
-        /// Returns a copy of the allocator
+        /// The state of the next frame, written while front() is read
         [[nodiscard]]
-        allocator_type get_allocator() const noexcept
+        back_view back() noexcept
         {
-            return m_data.get_allocator();
+            return back_view(m_ids, &m_buffers[m_front ^ 1], m_size);
         }
 
-        // -- Modifiers --
-
-        /// Removes all elements and invalidates all existing handles
-        void clear()
+        /** Applies the inserts, then the erases, recorded since the last swap, and makes the back
+         *  buffer the front one. Without pending changes, only flips an index. Applying changes
+         *  copies each inserted object into the other buffer and swap-and-pops each erased one in
+         *  both. If that copy throws, nothing is applied and the buffers are not swapped.
+         */
+        void swap_buffers()
         {
-            m_data.clear();
-            for (auto& m : m_metadata) {
-                ++m.generation;
+            if (!m_pending_ids.empty() || !m_erased.empty()) {
+                apply_pending();
             }
+            m_front ^= 1;
         }
 
-        /** Copies the provided object at the end of the vector
-         *  @return The stable ID to retrieve the object
-         */
+        /// Copies every live object of the front buffer into the back buffer
+        void copy_front_to_back()
+        {
+            const storage_type& from = m_buffers[m_front];
+            storage_type&       to   = m_buffers[m_front ^ 1];
+            std::copy(from.begin(), from.begin() + static_cast<std::ptrdiff_t>(m_size), to.begin());
+        }
+
+        // -- Deferred modifiers --
+
         [[nodiscard]]
         id_type push_back(const T& value)
         {
-            const id_type id = get_free_slot();
-            m_data.push_back(value);
-            return id;
+            return emplace_back(value);
         }
 
-        /** Moves the provided object at the end of the vector
-         *  @return The stable ID to retrieve the object
-         */
         [[nodiscard]]
         id_type push_back(T&& value)
         {
-            const id_type id = get_free_slot();
-            m_data.push_back(std::move(value));
-            return id;
+            return emplace_back(std::move(value));
         }
 
-        /** Constructs an element in-place at the end of the vector
-         *  @return The stable ID to retrieve the object
+        /** Constructs an object in the back buffer under a new ID that becomes live at the next
+         *  swap_buffers(), in both buffers. Until then, the ID is not live in either view.
+         *  @return The stable ID of the new object
          */
         template<typename... Args>
         [[nodiscard]]
         id_type emplace_back(Args&&... args)
         {
-            const id_type id = get_free_slot();
-            m_data.emplace_back(std::forward<Args>(args)...);
+            storage_type& back = m_buffers[m_front ^ 1];
+            detail::reserve_more(back, 1);
+            detail::reserve_more(m_pending_ids, 1);
+            back.emplace_back(std::forward<Args>(args)...);
+            generation_type generation;
+            id_type id;
+#if SIV_EXCEPTIONS
+            try {
+#endif
+                id = m_ids.detach(m_size, generation);
+#if SIV_EXCEPTIONS
+            } catch (...) {
+                back.pop_back();
+                throw;
+            }
+#endif
+            m_pending_ids.push_back({id, generation});
             return id;
         }
 
-        /// Removes the last element in data order
-        void pop_back()
-        {
-            assert(!empty() && "pop_back on empty vector");
-            erase_at(m_data.size() - 1);
-        }
-
-        /** Removes the object referenced by the provided stable ID
-         *  @param id The stable ID of the object to remove
+        /** Records the erasure of a live or pending ID. The object stays live in both buffers until
+         *  the next swap_buffers(). Erasing the same ID twice before the swap is an error.
          */
         void erase(id_type id)
         {
-            assert(id < m_indexes.size() && "ID out of range");
-            assert(m_indexes[id] < m_data.size() && "Object already erased or ID invalid");
-            const id_type data_idx      = m_indexes[id];
-            const id_type last_data_idx = m_data.size() - 1;
-            const id_type last_id       = m_metadata[last_data_idx].rid;
-            ++m_metadata[data_idx].generation;
-            std::swap(m_data[data_idx], m_data[last_data_idx]);
-            std::swap(m_metadata[data_idx], m_metadata[last_data_idx]);
-            std::swap(m_indexes[id], m_indexes[last_id]);
-            m_data.pop_back();
+            assert((contains(id) || m_ids.is_detached(id)) && "Object already erased or ID invalid");
+            m_erased.push_back(id);
         }
 
-        /** Removes the object referenced by the handle
-         *  @param h A handle to the object to remove
-         */
-        void erase(const handle<T, Allocator>& h)
+        /// Destroys every object and cancels the pending changes, at once
+        void clear()
         {
-            assert(h.m_vector == this && "Handle does not belong to this vector");
-            assert(h.valid() && "Handle references an erased object");
-            erase(h.id());
+            m_ids.prepare_attach(m_pending_ids.size());
+            for (const pending_id& p : m_pending_ids) {
+                m_ids.attach(p.id, p.generation, m_size, false);
+            }
+            m_pending_ids.clear();
+            m_erased.clear();
+            m_ids.release_all(m_size);
+            m_buffers[0].clear();
+            m_buffers[1].clear();
+            m_size = 0;
         }
 
-        /** Removes the object at the given data index
-         *  @param idx Position in the contiguous data array
-         */
-        void erase_at(size_type idx)
+        void reserve(size_type new_cap)
         {
-            assert(idx < m_data.size() && "Index out of range");
-            erase(m_metadata[idx].rid);
+            m_buffers[0].reserve(new_cap);
+            m_buffers[1].reserve(new_cap);
+            m_ids.reserve(new_cap);
         }
 
-        /** Removes all elements matching the predicate (C++20-style member)
-         *  @param predicate Unary predicate returning true for elements to remove
-         */
-        template<typename Pred>
-        void erase_if(Pred&& predicate)
+        // -- Stable-ID operations --
+
+        /// Number of live objects, the size of both views
+        [[nodiscard]]
+        size_type size() const noexcept
         {
-            for (size_type i{0}; i < m_data.size();) {
-                if (predicate(m_data[i])) {
-                    erase_at(i);
-                } else {
-                    ++i;
-                }
-            }
+            return m_size;
         }
 
-        // -- Stable-ID specific operations --
-
-        /** Returns the current data index for the given ID
-         *  @param id The stable ID
-         */
         [[nodiscard]]
-        size_type index_of(id_type id) const
+        bool empty() const noexcept
         {
-            assert(id < m_indexes.size() && "ID out of range");
-            return m_indexes[id];
+            return m_size == 0;
         }
 
-        /** Creates a handle pointing to the given stable ID
-         *  @param id The stable ID of a live object
-         */
-        handle<T, Allocator> make_handle(id_type id)
+        /// Number of inserts and erases waiting for the next swap_buffers()
+        [[nodiscard]]
+        size_type pending() const noexcept
         {
-            assert(id < m_indexes.size() && m_indexes[id] < m_data.size());
-            return {id, m_metadata[m_indexes[id]].generation, this};
+            return m_pending_ids.size() + m_erased.size();
         }
 
-        /** Creates a handle from a data index
-         *  @param idx Position in the contiguous data array
-         */
-        handle<T, Allocator> make_handle_at(size_type idx)
+        /// Checks whether the ID references a live object
+        [[nodiscard]]
+        bool contains(id_type id) const noexcept
         {
-            assert(idx < size());
-            return {m_metadata[idx].rid, m_metadata[idx].generation, this};
+            return m_ids.contains(id, m_size);
         }
 
-        /** Checks if an ID + generation pair still references a live object.
-         *  Used internally by handle::valid().
-         */
+        /// Checks whether an ID + generation pair still references a live object
         [[nodiscard]]
-        bool is_valid(id_type id, id_type generation) const noexcept
+        bool is_valid(id_type id, generation_type generation) const noexcept
         {
-            if (id >= m_indexes.size() || m_indexes[id] >= m_metadata.size()) {
-                return false;
-            }
-            return generation == m_metadata[m_indexes[id]].generation;
+            return m_ids.is_valid(id, generation, m_size);
         }
 
-        /// Returns the generation counter for the given ID
+        /// Returns the generation counter for the given live ID
         [[nodiscard]]
-        id_type generation(id_type id) const
+        generation_type generation(id_type id) const
         {
-            assert(id < m_indexes.size() && "ID out of range");
-            return m_metadata[m_indexes[id]].generation;
+            return m_ids.generation(id);
         }
 
-        /// Returns the ID that would be assigned to the next inserted element
+        /// Returns the current position of the given live ID, the same in both buffers
         [[nodiscard]]
-        id_type next_id() const
+        size_type index_of(id_type id) const
         {
-            if (m_metadata.size() > m_data.size()) {
-                return m_metadata[m_data.size()].rid;
-            }
-            return m_data.size();
+            return m_ids.index(id);
         }
 
-        /// Checks whether the ID references a currently live object
         [[nodiscard]]
-        bool contains(id_type id) const noexcept
+        allocator_type get_allocator() const noexcept
         {
-            return id < m_indexes.size() && m_indexes[id] < m_data.size();
+            return m_buffers[0].get_allocator();
         }
 
     private:
-        void check_at(id_type id) const
+        struct pending_id
         {
-            if (id >= m_indexes.size() || m_indexes[id] >= m_data.size()) {
-#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
-                throw std::out_of_range("siv::vector::at: invalid id");
-#else
-                assert(false && "siv::vector::at: invalid id");
-#endif
-            }
-        }
+            id_type         id;
+            generation_type generation;
+        };
 
-        id_type get_free_slot()
-        {
-            const id_type id = get_free_id();
-            m_indexes[id] = m_data.size();
-            return id;
-        }
+        using id_allocator_type      = typename std::allocator_traits<Allocator>::template rebind_alloc<id_type>;
+        using pending_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<pending_id>;
 
-        id_type get_free_id()
+        void apply_pending()
         {
-            if (m_metadata.size() > m_data.size()) {
-                ++m_metadata[m_data.size()].generation;
-                return m_metadata[m_data.size()].rid;
+            storage_type& front = m_buffers[m_front];
+            storage_type& back  = m_buffers[m_front ^ 1];
+            // Everything that can throw first: the ID tables and the front buffer make room, then the
+            // inserted objects are copied behind the live ones of the front buffer
+            m_ids.prepare_attach(m_pending_ids.size());
+            m_ids.prepare_release(m_erased.size());
+            detail::reserve_more(front, m_pending_ids.size());
+#if SIV_EXCEPTIONS
+            try {
+#endif
+                for (size_type pos = m_size; pos < back.size(); ++pos) {
+                    front.push_back(back[pos]);
+                }
+#if SIV_EXCEPTIONS
+            } catch (...) {
+                while (front.size() > m_size) {
+                    front.pop_back();
+                }
+                throw;
+            }
+#endif
+            for (const pending_id& p : m_pending_ids) {
+                m_ids.attach(p.id, p.generation, m_size, true);
+                ++m_size;
             }
-            const id_type new_id = m_data.size();
-            // Reserve both before modifying either to prevent desync on allocation failure
-            m_indexes.reserve(m_indexes.size() + 1);
-            m_metadata.reserve(m_metadata.size() + 1);
-            // After successful reserves, push_back on trivial types cannot throw
-            m_metadata.push_back({new_id, 0});
-            m_indexes.push_back(new_id);
-            return new_id;
+            m_pending_ids.clear();
+            for (const id_type id : m_erased) {
+                const size_type pos = m_ids.release(id, m_size);
+                for (storage_type& buffer : m_buffers) {
+                    if constexpr (relocates) {
+                        buffer.swap_and_pop(pos);
+                    } else {
+                        std::swap(buffer[pos], buffer.back());
+                        buffer.pop_back();
+                    }
+                }
+                --m_size;
+            }
+            m_erased.clear();
         }
 
-        std::vector<T, Allocator>                      m_data;
-        std::vector<metadata, metadata_allocator_type>  m_metadata;
-        std::vector<id_type, index_allocator_type>      m_indexes;
+        storage_type                                                                   m_buffers[2];
+        id_table_type                                                                  m_ids;
+        typename Traits::template table_storage<pending_id, pending_allocator_type>    m_pending_ids;
+        typename Traits::template table_storage<id_type, id_allocator_type>            m_erased;
+        size_type                                                                      m_size{0};
+        unsigned                                                                       m_front{0};
     };
-
-    // -- Non-member functions --
-
-    /// Erases all elements matching the predicate (C++20-style free function)
-    /// @return The number of elements removed
-    template<typename T, typename Allocator, typename Pred>
-    typename vector<T, Allocator>::size_type erase_if(vector<T, Allocator>& v, Pred predicate)
-    {
-        const auto old_size = v.size();
-        v.erase_if(std::move(predicate));
-        return old_size - v.size();
-    }
-
-    /// @note Comparisons operate on elements in data-order (internal storage order),
-    /// which may differ from insertion order after deletions (swap-to-back).
-    template<typename T, typename Allocator>
-    bool operator==(const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
-    {
-        return lhs.size() == rhs.size()
-            && std::equal(lhs.begin(), lhs.end(), rhs.begin());
-    }
-
-    template<typename T, typename Allocator>
-    bool operator!=(const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
-    {
-        return !(lhs == rhs);
-    }
-
-    template<typename T, typename Allocator>
-    bool operator<(const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
-    {
-        return std::lexicographical_compare(lhs.begin(), lhs.end(),
-                                            rhs.begin(), rhs.end());
-    }
-
-    template<typename T, typename Allocator>
-    bool operator<=(const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
-    {
-        return !(rhs < lhs);
-    }
-
-    template<typename T, typename Allocator>
-    bool operator>(const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
-    {
-        return rhs < lhs;
-    }
-
-    template<typename T, typename Allocator>
-    bool operator>=(const vector<T, Allocator>& lhs, const vector<T, Allocator>& rhs)
-    {
-        return !(lhs < rhs);
-    }
 }
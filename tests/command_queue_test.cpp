@@ -0,0 +1,176 @@
+// command_queue::flush() under different thread schedules: the same recorded buffers give the same
+// IDs, the same data order and the same free IDs, whether the workers record one after another or
+// side by side. Erasures of dead, duplicate and same-tick IDs are resolved the same way too.
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct record
+    {
+        std::uint32_t worker = 0;
+        std::uint32_t tick   = 0;
+        std::uint32_t seq    = 0;
+        siv::id_type  parent = siv::vector<record>::invalid_id;
+    };
+
+    using queue_type = siv::command_queue<record, std::allocator<record>, siv::default_traits>;
+
+    /// Everything a flush can influence: the handed-out IDs and the vector after each tick
+    struct history
+    {
+        std::vector<siv::id_type>  ids;
+        std::vector<std::uint64_t> contents;
+
+        bool operator==(const history& other) const
+        {
+            return ids == other.ids && contents == other.contents;
+        }
+    };
+
+    enum class schedule
+    {
+        concurrent,    ///< All workers record at once
+        reversed,      ///< One worker after the other, the last one first
+        interleaved,   ///< At once, yielding between commands
+    };
+
+    constexpr int           worker_count   = 4;
+    constexpr std::size_t   ids_per_buffer = 64;
+    constexpr std::uint32_t tick_count     = 40;
+
+    /** The commands of worker `w` in `tick`, from its own seed: insertions referencing earlier ones
+     *  of the same tick, erasures of objects live at the start of the tick (other workers may pick
+     *  the same), of its own new objects, and of IDs erased before, which may be in use again.
+     */
+    void record_tick(queue_type::buffer_type& buffer, int w, std::uint32_t tick, schedule mode,
+                     const std::vector<siv::id_type>& live, const std::vector<siv::id_type>& dead,
+                     std::vector<siv::id_type>& inserted)
+    {
+        std::mt19937 rng(tick * 131 + static_cast<std::uint32_t>(w));
+        const std::size_t inserts = rng() % (ids_per_buffer + 1);
+        siv::id_type parent = siv::vector<record>::invalid_id;
+        for (std::uint32_t i = 0; i < inserts; ++i) {
+            parent = buffer.emplace(record{static_cast<std::uint32_t>(w), tick, i, parent});
+            inserted.push_back(parent);
+            if (rng() % 8 == 0) {
+                buffer.erase(parent);
+            }
+            if (mode == schedule::interleaved) {
+                std::this_thread::yield();
+            }
+        }
+        // A full buffer refuses further insertions
+        if (buffer.available() == 0) {
+            bool threw = false;
+            try {
+                (void)buffer.emplace(record{});
+            } catch (const std::length_error&) {
+                threw = true;
+            }
+            assert(threw);
+        }
+        const std::size_t erases = live.empty() ? 0 : rng() % 12;
+        for (std::size_t i = 0; i < erases; ++i) {
+            buffer.erase(live[rng() % live.size()]);
+        }
+        for (std::size_t i = 0; !dead.empty() && i < 3; ++i) {
+            buffer.erase(dead[rng() % dead.size()]);
+        }
+        assert(buffer.pending_inserts() == inserts);
+    }
+
+    history run(schedule mode)
+    {
+        siv::vector<record> vec;
+        for (std::uint32_t i = 0; i < 100; ++i) {
+            (void)vec.push_back(record{99, 0, i});
+        }
+        history h;
+        std::vector<siv::id_type> dead;
+        {
+            queue_type queue(vec, worker_count, ids_per_buffer);
+            for (std::uint32_t tick = 1; tick <= tick_count; ++tick) {
+                std::vector<siv::id_type> live;
+                vec.for_each([&](siv::id_type id, const record&) { live.push_back(id); });
+
+                std::vector<std::vector<siv::id_type>> inserted(worker_count);
+                auto work = [&](int w) {
+                    record_tick(queue.buffer(static_cast<std::size_t>(w)), w, tick, mode, live, dead, inserted[w]);
+                };
+                if (mode == schedule::reversed) {
+                    for (int w = worker_count - 1; w >= 0; --w) {
+                        std::thread(work, w).join();
+                    }
+                } else {
+                    std::atomic<bool> start{false};
+                    std::vector<std::thread> threads;
+                    for (int w = 0; w < worker_count; ++w) {
+                        threads.emplace_back([&, w] {
+                            while (!start.load()) {
+                                std::this_thread::yield();
+                            }
+                            work(w);
+                        });
+                    }
+                    start.store(true);
+                    for (std::thread& t : threads) {
+                        t.join();
+                    }
+                }
+                queue.flush();
+
+                // Insertions come first, so an object erased in the tick it was inserted in is gone
+                for (int w = 0; w < worker_count; ++w) {
+                    for (const siv::id_type id : inserted[w]) {
+                        h.ids.push_back(id);
+                        if (!vec.contains(id)) {
+                            dead.push_back(id);
+                        }
+                    }
+                    assert(queue.buffer(static_cast<std::size_t>(w)).pending_inserts() == 0);
+                    assert(queue.buffer(static_cast<std::size_t>(w)).available() == ids_per_buffer);
+                }
+                for (const siv::id_type id : live) {
+                    if (!vec.contains(id)) {
+                        dead.push_back(id);
+                    }
+                }
+                vec.for_each([&](siv::id_type id, const record& r) {
+                    // A new record references the previous one of its worker, if that one is still live
+                    if (r.tick == tick && r.seq > 0 && vec.contains(r.parent)) {
+                        const record& p = vec[r.parent];
+                        assert(p.worker == r.worker && p.tick == r.tick && p.seq + 1 == r.seq);
+                    }
+                    h.contents.push_back(id);
+                    h.contents.push_back(static_cast<std::uint64_t>(vec.generation(id)));
+                    h.contents.push_back((std::uint64_t{r.worker} << 48) | (std::uint64_t{r.tick} << 24) | r.seq);
+                    h.contents.push_back(r.parent);
+                });
+            }
+        }
+        // Destroying the queue returns its reserved IDs, in the same order under every schedule
+        for (int i = 0; i < worker_count * static_cast<int>(ids_per_buffer); ++i) {
+            h.ids.push_back(vec.push_back(record{}));
+        }
+        return h;
+    }
+}
+
+int main()
+{
+    const history reference = run(schedule::reversed);
+    for (int r = 0; r < 3; ++r) {
+        assert(run(schedule::concurrent) == reference);
+        assert(run(schedule::interleaved) == reference);
+    }
+    return 0;
+}
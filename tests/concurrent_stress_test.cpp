@@ -0,0 +1,131 @@
+// Several producers push into one siv::concurrent_vector while readers look elements up and walk
+// it: every ID is handed out once, segments are installed once, and readers only ever see fully
+// constructed elements. Built a second time with ThreadSanitizer when the compiler supports it.
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// Checkable on its own; the constructor throws on request, which abandons the slot
+    struct item
+    {
+        std::uint64_t producer = 0;
+        std::uint64_t seq      = 0;
+        std::uint64_t check    = 0;
+
+        item(std::uint64_t p, std::uint64_t s, bool fail)
+            : producer{p}
+            , seq{s}
+            , check{p * 1000003 + s}
+        {
+            if (fail) {
+                throw std::runtime_error("construction failed");
+            }
+        }
+
+        [[nodiscard]] bool intact() const { return check == producer * 1000003 + seq; }
+    };
+
+    constexpr int           producer_count = 8;
+    constexpr int           reader_count   = 2;
+    constexpr std::uint64_t per_producer   = 20000;
+
+    /// Every 97th push of a producer throws
+    constexpr bool fails(std::uint64_t seq) { return seq % 97 == 96; }
+
+    void round(siv::concurrent_vector<item>& vec)
+    {
+        std::atomic<bool> start{false};
+        std::atomic<int>  producing{producer_count};
+        std::vector<std::vector<siv::id_type>> ids(producer_count);
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producer_count; ++p) {
+            threads.emplace_back([&, p] {
+                while (!start.load()) {
+                    std::this_thread::yield();
+                }
+                for (std::uint64_t s = 0; s < per_producer; ++s) {
+                    try {
+                        ids[p].push_back(vec.emplace_back(static_cast<std::uint64_t>(p), s, fails(s)));
+                    } catch (const std::runtime_error&) {
+                        assert(fails(s));
+                    }
+                }
+                producing.fetch_sub(1);
+            });
+        }
+        for (int r = 0; r < reader_count; ++r) {
+            threads.emplace_back([&, r] {
+                while (!start.load()) {
+                    std::this_thread::yield();
+                }
+                std::uint64_t probe = static_cast<std::uint64_t>(r);
+                while (producing.load() > 0) {
+                    // Random lookups below the claimed size, and one walk now and then
+                    const std::size_t n = vec.size();
+                    if (n > 0) {
+                        probe = probe * 6364136223846793005ull + 1442695040888963407ull;
+                        if (const item* it = vec.find(static_cast<siv::id_type>((probe >> 16) % n))) {
+                            assert(it->intact() && !fails(it->seq));
+                        }
+                    }
+                    if (probe % 64 == 0) {
+                        vec.for_each([](siv::id_type, const item& it) { assert(it.intact()); });
+                    }
+                }
+            });
+        }
+        start.store(true);
+        for (std::thread& t : threads) {
+            t.join();
+        }
+
+        // Each producer got increasing, distinct IDs; together with the abandoned slots they cover
+        // every claimed ID exactly once
+        const std::uint64_t abandoned_per_producer = per_producer / 97;
+        const std::size_t pushed = producer_count * (per_producer - abandoned_per_producer);
+        assert(vec.size() == producer_count * per_producer);
+        std::vector<unsigned char> seen(vec.size(), 0);
+        for (int p = 0; p < producer_count; ++p) {
+            assert(ids[p].size() == per_producer - abandoned_per_producer);
+            for (std::size_t i = 0; i < ids[p].size(); ++i) {
+                const siv::id_type id = ids[p][i];
+                assert(i == 0 || ids[p][i - 1] < id);
+                assert(!seen[id]);
+                seen[id] = 1;
+                const item& it = vec[id];
+                assert(it.intact() && it.producer == static_cast<std::uint64_t>(p));
+            }
+        }
+        std::size_t visited = 0;
+        vec.for_each([&](siv::id_type id, const item& it) {
+            assert(seen[id] && it.intact());
+            ++visited;
+        });
+        assert(visited == pushed);
+        for (std::size_t id = 0; id < seen.size(); ++id) {
+            assert(vec.contains(static_cast<siv::id_type>(id)) == (seen[id] != 0));
+        }
+        assert(vec.capacity() >= vec.size());
+    }
+}
+
+int main()
+{
+    siv::concurrent_vector<item> vec;
+    round(vec);
+    // Again in the segments kept by clear()
+    const std::size_t capacity = vec.capacity();
+    vec.clear();
+    assert(vec.empty() && vec.capacity() == capacity);
+    round(vec);
+    return 0;
+}
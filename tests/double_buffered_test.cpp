@@ -0,0 +1,240 @@
+// siv::double_buffered_vector against a model of both frames: inserts and erases stay pending
+// until swap_buffers(), a throwing copy applies nothing, erasing a pending ID cancels it, and
+// copy_front_to_back() makes both buffers equal
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <cassert>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    /// Copying throws once the countdown reaches zero
+    struct fragile
+    {
+        static inline int countdown = -1;
+
+        int value = 0;
+
+        explicit fragile(int v) : value(v) {}
+
+        fragile(const fragile& other) : value(other.value)
+        {
+            if (countdown >= 0 && countdown-- == 0) {
+                throw std::runtime_error("copy failed");
+            }
+        }
+
+        fragile& operator=(const fragile&) = default;
+    };
+
+    /// The objects of a live ID in the front and the back buffer
+    struct frames
+    {
+        int front = 0;
+        int back  = 0;
+    };
+
+    template<typename Vector>
+    void check(Vector& vec, const std::map<typename Vector::id_type, frames>& live)
+    {
+        const auto front = vec.front();
+        const auto back  = vec.back();
+        assert(vec.size() == live.size() && front.size() == live.size() && back.size() == live.size());
+        for (const auto& [id, f] : live) {
+            assert(vec.contains(id) && front.contains(id) && back.contains(id));
+            assert(front[id].value == f.front && back[id].value == f.back);
+            assert(front.find(id) == &front.at_position(vec.index_of(id)));
+            assert(vec.is_valid(id, vec.generation(id)));
+        }
+        // Both buffers hold the same IDs at the same positions
+        for (std::size_t pos = 0; pos < live.size(); ++pos) {
+            assert(front.get_id_at(pos) == back.get_id_at(pos));
+            assert(live.count(front.get_id_at(pos)) == 1);
+        }
+        std::size_t visited = 0;
+        front.for_each([&](typename Vector::id_type id, const fragile& obj) {
+            assert(live.at(id).front == obj.value);
+            ++visited;
+        });
+        assert(visited == live.size());
+    }
+
+    /// Random frames of writes, inserts and erases, checked against the model after every swap
+    template<typename Traits>
+    void model(std::mt19937& rng)
+    {
+        using vector_type = siv::double_buffered_vector<fragile, std::allocator<fragile>, Traits>;
+        using id_type     = typename vector_type::id_type;
+
+        vector_type vec;
+        std::map<id_type, frames> live;
+        std::vector<std::pair<id_type, typename vector_type::generation_type>> dead;
+        int next_value = 1;
+
+        for (int frame = 0; frame < 200; ++frame) {
+            std::map<id_type, int> inserted;
+            std::vector<id_type>   erased;
+            std::vector<id_type>   live_ids;
+            for (const auto& [id, f] : live) {
+                live_ids.push_back(id);
+            }
+
+            // Write the next frame of every live object, as a simulation step would
+            for (const id_type id : live_ids) {
+                const int value = next_value++;
+                vec.back()[id].value = value;
+                live[id].back = value;
+            }
+            const int inserts = static_cast<int>(rng() % 8);
+            for (int i = 0; i < inserts; ++i) {
+                const int value = next_value++;
+                const id_type id = vec.push_back(fragile{value});
+                assert(!vec.contains(id) && !vec.front().contains(id) && !vec.back().contains(id));
+                inserted[id] = value;
+            }
+            // Erase live and pending IDs, each at most once
+            std::shuffle(live_ids.begin(), live_ids.end(), rng);
+            const std::size_t erases = live_ids.empty() ? 0 : rng() % (live_ids.size() / 4 + 2);
+            for (std::size_t i = 0; i < erases && i < live_ids.size(); ++i) {
+                dead.emplace_back(live_ids[i], vec.generation(live_ids[i]));
+                vec.erase(live_ids[i]);
+                erased.push_back(live_ids[i]);
+            }
+            for (const auto& [id, value] : inserted) {
+                if (rng() % 4 == 0) {
+                    vec.erase(id);
+                    erased.push_back(id);
+                }
+            }
+            assert(vec.pending() == inserted.size() + erased.size());
+            // Nothing is applied before the swap: erased objects are still live
+            check(vec, live);
+
+            vec.swap_buffers();
+            assert(vec.pending() == 0);
+            for (auto& [id, f] : live) {
+                std::swap(f.front, f.back);
+            }
+            for (const auto& [id, value] : inserted) {
+                live[id] = frames{value, value};
+            }
+            for (const id_type id : erased) {
+                live.erase(id);
+            }
+            check(vec, live);
+            for (const auto& [id, generation] : dead) {
+                assert(!vec.is_valid(id, generation));
+            }
+
+            if (frame % 16 == 15) {
+                vec.copy_front_to_back();
+                for (auto& [id, f] : live) {
+                    f.back = f.front;
+                }
+                check(vec, live);
+            }
+        }
+    }
+
+    /// A copy that throws while a swap applies the inserts leaves everything pending
+    template<typename Traits>
+    void throwing_copy_applies_nothing()
+    {
+        using vector_type = siv::double_buffered_vector<fragile, std::allocator<fragile>, Traits>;
+        using id_type     = typename vector_type::id_type;
+
+        vector_type vec;
+        std::map<id_type, frames> live;
+        for (int i = 0; i < 4; ++i) {
+            live[vec.push_back(fragile{i})] = frames{i, i};
+        }
+        vec.swap_buffers();
+        vec.copy_front_to_back();
+        check(vec, live);
+
+        std::vector<id_type> inserted;
+        for (int i = 10; i < 15; ++i) {
+            inserted.push_back(vec.push_back(fragile{i}));
+        }
+        const id_type erased = live.begin()->first;
+        vec.erase(erased);
+        vec.erase(inserted[1]);
+
+        // Fail on the third of the five copies into the front buffer
+        fragile::countdown = 2;
+        bool threw = false;
+        try {
+            vec.swap_buffers();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        fragile::countdown = -1;
+        assert(threw);
+        // Same front buffer, same live IDs, and every change still pending
+        assert(vec.pending() == 7);
+        check(vec, live);
+        for (const id_type id : inserted) {
+            assert(!vec.contains(id));
+        }
+
+        vec.swap_buffers();
+        live.erase(erased);
+        for (int i = 0; i < 5; ++i) {
+            if (i != 1) {
+                live[inserted[i]] = frames{10 + i, 10 + i};
+            }
+        }
+        assert(!vec.contains(inserted[1]) && !vec.contains(erased));
+        check(vec, live);
+    }
+
+    /// clear() drops the pending changes too, and the IDs are handed out again
+    template<typename Traits>
+    void clear_cancels_pending()
+    {
+        using vector_type = siv::double_buffered_vector<fragile, std::allocator<fragile>, Traits>;
+        using id_type     = typename vector_type::id_type;
+
+        vector_type vec;
+        std::vector<id_type> ids;
+        for (int i = 0; i < 5; ++i) {
+            ids.push_back(vec.push_back(fragile{i}));
+        }
+        vec.swap_buffers();
+        const auto generation = vec.generation(ids[0]);
+        (void)vec.push_back(fragile{5});
+        vec.erase(ids[1]);
+        vec.clear();
+        assert(vec.empty() && vec.pending() == 0 && vec.front().empty() && vec.back().empty());
+        assert(!vec.is_valid(ids[0], generation));
+
+        vec.swap_buffers();
+        assert(vec.empty());
+        const id_type id = vec.push_back(fragile{7});
+        assert(id < 6);
+        vec.swap_buffers();
+        assert(vec.size() == 1 && vec.front()[id].value == 7 && vec.back()[id].value == 7);
+    }
+
+    template<typename Traits>
+    void run(std::mt19937& rng)
+    {
+        model<Traits>(rng);
+        throwing_copy_applies_nothing<Traits>();
+        clear_cancels_pending<Traits>();
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(25);
+    run<siv::default_traits>(rng);
+    run<siv::compact_traits>(rng);
+    run<siv::recycling_traits<siv::recycle_policy::fifo>>(rng);
+    run<siv::relocating_traits<>>(rng);
+    return 0;
+}
@@ -0,0 +1,168 @@
+// One writer and several readers on a siv::epoch_vector: every view must show exactly the state
+// published for its version, including views held while the writer grows and reorders the vector.
+// Built a second time with ThreadSanitizer when the compiler supports it.
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// Non-trivial element, so that snapshots copy-construct and destroy it
+    struct record
+    {
+        std::uint64_t key = 0;
+        std::string   text;
+
+        explicit record(std::uint64_t k)
+            : key{k}
+            , text(std::to_string(k))
+        {}
+
+        [[nodiscard]] bool intact() const { return text == std::to_string(key); }
+    };
+
+    /// Size and key sum of the state published as one version
+    struct expected_state
+    {
+        std::atomic<std::uint64_t> size{0};
+        std::atomic<std::uint64_t> sum{0};
+    };
+
+    constexpr int         reader_count = 4;
+    constexpr std::size_t rounds       = 300;
+
+    template<typename Traits>
+    void stress()
+    {
+        using vector_type = siv::epoch_vector<record, reader_count, std::allocator<record>, Traits>;
+        using id_type     = typename vector_type::id_type;
+        using view_type   = typename vector_type::view;
+
+        vector_type vec;
+        // Indexed by version, filled by the writer before it publishes that version
+        std::vector<expected_state> expected(rounds + 1);
+        std::atomic<std::uint64_t> published{0};
+        std::atomic<int> registered{0};
+        std::atomic<bool> stop{false};
+        std::atomic<std::uint64_t> views_checked{0};
+
+        // Every element is intact, findable by its ID, and the view matches its version
+        auto check_view = [&](const view_type& view) {
+            std::uint64_t size = 0;
+            std::uint64_t sum  = 0;
+            view.for_each([&](id_type id, const record& r) {
+                assert(r.intact());
+                assert(view.find(id) == &r);
+                ++size;
+                sum += r.key;
+            });
+            assert(size == view.size());
+            assert(size == expected[view.version()].size.load(std::memory_order_relaxed));
+            assert(sum == expected[view.version()].sum.load(std::memory_order_relaxed));
+        };
+
+        std::vector<std::thread> readers;
+        for (int t = 0; t < reader_count; ++t) {
+            readers.emplace_back([&, t] {
+                typename vector_type::reader reader(vec);
+                registered.fetch_add(1, std::memory_order_relaxed);
+                std::mt19937 rng(static_cast<unsigned>(t));
+                for (std::uint64_t n = 0; !stop.load(std::memory_order_relaxed); ++n) {
+                    const view_type view = reader.read();
+                    check_view(view);
+                    // Pointers into a view stay valid for its whole life
+                    const record* first = view.empty() ? nullptr : view.begin();
+                    for (int i = 0; i < 20; ++i) {
+                        if (const record* r = view.find(static_cast<id_type>(rng() % 4096))) {
+                            assert(r->intact());
+                        }
+                    }
+                    if (n % 8 == 0) {
+                        // Hold the view while the writer publishes a few more versions, then check it again
+                        const std::uint64_t pinned = view.version();
+                        while (!stop.load(std::memory_order_relaxed) && published.load(std::memory_order_relaxed) < pinned + 3) {
+                            std::this_thread::yield();
+                        }
+                        check_view(view);
+                        assert(view.empty() || view.begin() == first);
+                    }
+                    views_checked.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        // Every reader pins snapshots while the writer runs
+        while (registered.load(std::memory_order_relaxed) < reader_count) {
+            std::this_thread::yield();
+        }
+
+        std::mt19937 rng(7);
+        std::map<id_type, std::uint64_t> model;
+        std::uint64_t next_key = 1;
+        for (std::size_t round = 1; round <= rounds; ++round) {
+            // Grow past the capacity of the previous snapshots, then erase part of it
+            for (int i = 0; i < 40; ++i) {
+                const std::uint64_t key = next_key++;
+                model[vec.emplace_back(key)] = key;
+            }
+            for (int i = 0; i < 25 && !model.empty(); ++i) {
+                auto it = model.begin();
+                std::advance(it, static_cast<long>(rng() % model.size()));
+                vec.erase(it->first);
+                model.erase(it);
+            }
+            if (round % 13 == 0) {
+                vec.write([](auto& v) { v.sort([](const record& a, const record& b) { return a.key > b.key; }); });
+            }
+            if (round % 31 == 0) {
+                vec.write([](auto& v) { v.shrink_to_fit(); });
+            }
+            if (round % 97 == 0) {
+                vec.clear();
+                model.clear();
+            }
+            std::uint64_t sum = 0;
+            for (const auto& entry : model) {
+                sum += entry.second;
+            }
+            expected[round].size.store(model.size(), std::memory_order_relaxed);
+            expected[round].sum.store(sum, std::memory_order_relaxed);
+            vec.publish();
+            assert(vec.version() == round);
+            published.store(round, std::memory_order_relaxed);
+            if (round % 5 == 0) {
+                vec.reclaim();
+            }
+        }
+        stop.store(true, std::memory_order_relaxed);
+        for (std::thread& t : readers) {
+            t.join();
+        }
+
+        // With every reader gone, every replaced snapshot can be freed
+        vec.reclaim();
+        assert(vec.retired_count() == 0);
+        assert(views_checked.load() > 0);
+        typename vector_type::reader reader(vec);
+        const view_type view = reader.read();
+        assert(view.size() == model.size());
+        for (const auto& [id, key] : model) {
+            assert(view.contains(id) && view[id].key == key);
+        }
+    }
+}
+
+int main()
+{
+    stress<siv::default_traits>();
+    stress<siv::compact_traits>();
+    return 0;
+}
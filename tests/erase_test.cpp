@@ -0,0 +1,129 @@
+// Batch erasure against a model: erase_if(), erase(ids), erase(handles) and the parallel
+// erase_if(), on every erase policy and a few ID layouts, and soa_vector::erase_if()
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace
+{
+    /// Every modelled ID is live with its value, no other element is, and erased handles are stale
+    template<typename Vector, typename Model, typename Handles>
+    void check(const Vector& vec, const Model& model, const Handles& erased)
+    {
+        assert(vec.size() == model.size());
+        for (const auto& [id, value] : model) {
+            assert(vec.contains(id) && vec[id] == value);
+        }
+        std::size_t live = 0;
+        vec.for_each([&](typename Vector::id_type id, const std::uint64_t& value) {
+            assert(model.at(id) == value);
+            ++live;
+        });
+        assert(live == model.size());
+        for (const auto& h : erased) {
+            assert(!h.valid());
+        }
+    }
+
+    template<typename Traits>
+    void batch_erase(std::mt19937& rng)
+    {
+        using vector_type = siv::vector<std::uint64_t, std::allocator<std::uint64_t>, Traits>;
+        using id_type     = typename vector_type::id_type;
+        using handle_type = typename vector_type::handle_type;
+
+        vector_type vec;
+        std::map<id_type, std::uint64_t> model;
+        std::vector<handle_type> erased;
+        for (int round = 0; round < 40; ++round) {
+            const int inserts = static_cast<int>(rng() % 300);
+            for (int i = 0; i < inserts; ++i) {
+                const std::uint64_t value = rng() % 1000;
+                model[vec.push_back(value)] = value;
+            }
+
+            // Erase a random sample of IDs, as IDs or as handles
+            std::vector<id_type> ids;
+            for (const auto& entry : model) {
+                if (rng() % 4 == 0) {
+                    ids.push_back(entry.first);
+                }
+            }
+            for (std::size_t i = ids.size(); i > 1; --i) {
+                std::swap(ids[i - 1], ids[rng() % i]);
+            }
+            for (const id_type id : ids) {
+                erased.push_back(vec.make_handle(id));
+                model.erase(id);
+            }
+            if (round % 2 == 0) {
+                vec.erase(siv::span<const id_type>(ids.data(), ids.size()));
+            } else {
+                std::vector<handle_type> handles(erased.end() - static_cast<std::ptrdiff_t>(ids.size()), erased.end());
+                vec.erase(siv::span<const handle_type>(handles.data(), handles.size()));
+            }
+            check(vec, model, erased);
+
+            // Erase by value, sequentially or in parallel; everything and nothing now and then
+            const std::uint64_t bound = round % 10 == 9 ? 1000 : round % 10 == 4 ? 0 : rng() % 500;
+            for (auto it = model.begin(); it != model.end();) {
+                if (it->second < bound) {
+                    erased.push_back(vec.make_handle(it->first));
+                    it = model.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            auto below = [bound](const std::uint64_t& value) { return value < bound; };
+            if (round % 3 == 0) {
+                vec.erase_if(siv::execution::par, below);
+            } else {
+                vec.erase_if(below);
+            }
+            check(vec, model, erased);
+        }
+    }
+
+    /// soa_vector::erase_if() keeps the columns of every surviving row together
+    void soa_erase(std::mt19937& rng)
+    {
+        siv::soa_vector<std::uint64_t, std::uint32_t> vec;
+        using id_type = siv::soa_vector<std::uint64_t, std::uint32_t>::id_type;
+        std::map<id_type, std::uint64_t> model;
+        for (int round = 0; round < 40; ++round) {
+            const int inserts = static_cast<int>(rng() % 300);
+            for (int i = 0; i < inserts; ++i) {
+                const std::uint64_t value = rng() % 1000;
+                model[vec.emplace_back(value, static_cast<std::uint32_t>(value * 7))] = value;
+            }
+            const std::uint64_t bound = rng() % 500;
+            vec.erase_if([bound](const auto& row) { return std::get<0>(row) < bound; });
+            for (auto it = model.begin(); it != model.end();) {
+                it = it->second < bound ? model.erase(it) : std::next(it);
+            }
+            assert(vec.size() == model.size());
+            for (const auto& [id, value] : model) {
+                assert(vec.contains(id));
+                const auto row = vec[id];
+                assert(std::get<0>(row) == value && std::get<1>(row) == value * 7);
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(3);
+    batch_erase<siv::default_traits>(rng);
+    batch_erase<siv::compact_traits>(rng);
+    batch_erase<siv::ordered_traits<>>(rng);
+    batch_erase<siv::recycling_traits<siv::recycle_policy::fifo>>(rng);
+    batch_erase<siv::relocating_traits<>>(rng);
+    soa_erase(rng);
+    return 0;
+}
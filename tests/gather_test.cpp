@@ -0,0 +1,95 @@
+// Batch lookups against operator[]: gather(), gather_values() and for_each(ids) on every length
+// around the prefetch distances, with repeated IDs, after erasures, and on paged storage
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+    struct entity
+    {
+        std::uint64_t key = 0;
+        std::uint32_t tag = 0;
+    };
+
+    struct colocated_traits : siv::default_traits
+    {
+        static constexpr bool colocated_generation = true;
+    };
+
+    template<typename Traits>
+    void check(std::mt19937& rng)
+    {
+        using vector_type = siv::vector<entity, std::allocator<entity>, Traits>;
+        using id_type     = typename vector_type::id_type;
+
+        vector_type vec;
+        std::vector<id_type> live;
+        for (std::uint64_t i = 0; i < 3000; ++i) {
+            live.push_back(vec.push_back(entity{i, static_cast<std::uint32_t>(i * 7)}));
+        }
+        // Erase a third, so that IDs and data positions no longer match, then refill part of it
+        for (std::size_t i = 0; i < 1000; ++i) {
+            const std::size_t k = rng() % live.size();
+            vec.erase(live[k]);
+            live[k] = live.back();
+            live.pop_back();
+        }
+        for (std::uint64_t i = 0; i < 400; ++i) {
+            live.push_back(vec.push_back(entity{10000 + i, static_cast<std::uint32_t>(i)}));
+        }
+
+        // Random live IDs, with repeats
+        std::vector<id_type> ids(1000);
+        for (id_type& id : ids) {
+            id = live[rng() % live.size()];
+        }
+        const vector_type& cvec = vec;
+        for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{31}, std::size_t{32}, std::size_t{33},
+                              std::size_t{63}, std::size_t{64}, std::size_t{65}, std::size_t{97}, ids.size()}) {
+            const siv::span<const id_type> first(ids.data(), n);
+
+            std::vector<entity*> ptrs(n, nullptr);
+            vec.gather(first, siv::span<entity*>(ptrs.data(), n));
+            std::vector<const entity*> cptrs(n, nullptr);
+            cvec.gather(first, siv::span<const entity*>(cptrs.data(), n));
+            std::vector<entity> copies(n);
+            cvec.gather_values(first, siv::span<entity>(copies.data(), n));
+            for (std::size_t i = 0; i < n; ++i) {
+                assert(ptrs[i] == &vec[ids[i]]);
+                assert(cptrs[i] == &cvec[ids[i]]);
+                assert(copies[i].key == vec[ids[i]].key && copies[i].tag == vec[ids[i]].tag);
+            }
+
+            // In the order of the IDs, with or without them
+            std::size_t visited = 0;
+            vec.for_each(first, [&](id_type id, entity& e) {
+                assert(id == ids[visited] && &e == &vec[id]);
+                ++visited;
+            });
+            assert(visited == n);
+            visited = 0;
+            cvec.for_each(first, [&](const entity& e) {
+                assert(&e == &cvec[ids[visited]]);
+                ++visited;
+            });
+            assert(visited == n);
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(14);
+    check<siv::default_traits>(rng);
+    check<siv::compact_traits>(rng);
+    check<colocated_traits>(rng);
+    check<siv::paged_traits<64>>(rng);
+    check<siv::paged_traits<256, siv::compact_traits>>(rng);
+    check<siv::ordered_traits<>>(rng);
+    return 0;
+}
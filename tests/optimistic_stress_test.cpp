@@ -0,0 +1,175 @@
+// One writer and several readers on a siv::optimistic_vector: a load returns either false or an
+// untorn copy of the object of that ID, while the writer inserts, erases, rewrites in place, grows,
+// shrinks and reclaims. Built a second time with ThreadSanitizer when the compiler supports it.
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// Trivially copyable, wider than a word, and checkable on its own: a torn copy mixes two seeds
+    struct sample
+    {
+        std::uint64_t id         = 0;
+        std::uint64_t generation = 0;
+        std::uint64_t seed       = 0;
+        std::uint64_t check[5]   = {};
+
+        void fill(std::uint64_t s)
+        {
+            seed = s;
+            for (std::uint64_t i = 0; i < 5; ++i) {
+                check[i] = (s + i) * 0x9E3779B97F4A7C15ull;
+            }
+        }
+
+        [[nodiscard]] bool intact() const
+        {
+            for (std::uint64_t i = 0; i < 5; ++i) {
+                if (check[i] != (seed + i) * 0x9E3779B97F4A7C15ull) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    constexpr int         reader_count = 4;
+    constexpr std::size_t rounds       = 1000;
+
+    template<typename Traits>
+    void stress()
+    {
+        using vector_type     = siv::optimistic_vector<sample, std::allocator<sample>, Traits>;
+        using id_type         = typename vector_type::id_type;
+        using generation_type = typename vector_type::generation_type;
+
+        vector_type vec;
+        std::atomic<bool> stop{false};
+        // reclaim() needs every reader out of load(): readers park while `pause` is set
+        std::atomic<bool> pause{false};
+        std::atomic<int>  parked{0};
+        std::atomic<std::uint64_t> hits{0};
+
+        std::vector<std::thread> readers;
+        for (int t = 0; t < reader_count; ++t) {
+            readers.emplace_back([&, t] {
+                std::mt19937 rng(static_cast<unsigned>(t));
+                std::uint64_t found = 0;
+                while (!stop.load()) {
+                    if (pause.load()) {
+                        parked.fetch_add(1);
+                        while (pause.load() && !stop.load()) {
+                            std::this_thread::yield();
+                        }
+                        parked.fetch_sub(1);
+                        continue;
+                    }
+                    const auto id = static_cast<id_type>(rng() % 2048);
+                    sample s;
+                    if (!vec.load(id, s)) {
+                        continue;
+                    }
+                    assert(s.intact());
+                    assert(s.id == id);
+                    ++found;
+                    // The same object, or false once erased; never the object that reuses the ID
+                    sample again;
+                    if (vec.load(id, static_cast<generation_type>(s.generation), again)) {
+                        assert(again.intact());
+                        assert(again.id == id && again.generation == s.generation);
+                    }
+                }
+                hits.fetch_add(found);
+            });
+        }
+
+        std::mt19937 rng(7);
+        std::map<id_type, std::uint64_t> model;
+        std::uint64_t next_seed = 1;
+        auto insert = [&] {
+            const std::uint64_t seed = next_seed++;
+            const id_type id = vec.write([&](auto& v) {
+                const auto new_id = v.emplace_back();
+                sample& s    = v[new_id];
+                s.id         = new_id;
+                s.generation = v.generation(new_id);
+                s.fill(seed);
+                return new_id;
+            });
+            model[id] = seed;
+        };
+        auto pick = [&] {
+            auto it = model.begin();
+            std::advance(it, static_cast<long>(rng() % model.size()));
+            return it;
+        };
+        for (std::size_t round = 1; round <= rounds; ++round) {
+            // Grow past the current capacity, rewrite some objects in place, erase some
+            for (int i = 0; i < 60; ++i) {
+                insert();
+            }
+            for (int i = 0; i < 20; ++i) {
+                auto it = pick();
+                it->second = next_seed++;
+                vec.write([&](auto& v) { v[it->first].fill(it->second); });
+            }
+            for (int i = 0; i < 45 && !model.empty(); ++i) {
+                auto it = pick();
+                vec.erase(it->first);
+                model.erase(it);
+            }
+            if (round % 7 == 0) {
+                const std::uint64_t bound = next_seed - 50;
+                vec.erase_if([bound](const sample& s) { return s.seed < bound; });
+                for (auto it = model.begin(); it != model.end();) {
+                    it = it->second < bound ? model.erase(it) : std::next(it);
+                }
+            }
+            if (round % 11 == 0) {
+                vec.write([](auto& v) { v.shrink_to_fit(); });
+            }
+            if (round % 53 == 0) {
+                vec.clear();
+                model.clear();
+            }
+            if (round % 9 == 0) {
+                pause.store(true);
+                while (parked.load() < reader_count) {
+                    std::this_thread::yield();
+                }
+                vec.reclaim();
+                assert(vec.retired_bytes() == 0);
+                pause.store(false);
+            }
+            assert(vec.version() % 2 == 0);
+        }
+        stop.store(true);
+        for (std::thread& t : readers) {
+            t.join();
+        }
+        assert(hits.load() > 0);
+
+        // The owner's view matches the model
+        vec.reclaim();
+        assert(vec.get().size() == model.size());
+        for (const auto& [id, seed] : model) {
+            sample s;
+            assert(vec.load(id, s) && s.intact() && s.seed == seed && s.id == id);
+        }
+    }
+}
+
+int main()
+{
+    stress<siv::default_traits>();
+    stress<siv::compact_traits>();
+    return 0;
+}
@@ -0,0 +1,101 @@
+// apply_permutation() against a model, sequential and parallel: without holes it reorders the
+// elements, and with the tombstone erase policy it takes a permutation of every slot, drops the
+// holes and compacts, leaving the live elements in the order the permutation gives them
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+    template<typename Traits, bool Parallel>
+    void check(std::mt19937& rng)
+    {
+        using vector_type = siv::vector<std::uint64_t, std::allocator<std::uint64_t>, Traits>;
+        using id_type     = typename vector_type::id_type;
+        constexpr bool tombstones = Traits::erase_mode == siv::erase_policy::tombstone;
+
+        for (std::size_t count : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{1000}}) {
+            vector_type vec;
+            if constexpr (tombstones) {
+                vec.set_max_hole_ratio(1.0);
+            }
+            std::vector<id_type> ids;
+            for (std::size_t i = 0; i < count; ++i) {
+                ids.push_back(vec.push_back(i * 3));
+            }
+            // Erase about a third; with tombstones they stay as holes
+            std::vector<id_type> live;
+            for (const id_type id : ids) {
+                if (rng() % 3 == 0) {
+                    vec.erase(id);
+                } else {
+                    live.push_back(id);
+                }
+            }
+
+            std::vector<std::size_t> perm(vec.slot_count());
+            for (std::size_t i = 0; i < perm.size(); ++i) {
+                perm[i] = i;
+            }
+            std::shuffle(perm.begin(), perm.end(), rng);
+
+            // The live IDs in the order of their slot in `perm`
+            std::vector<id_type> slot_id(vec.slot_count(), vector_type::invalid_id);
+            for (const id_type id : live) {
+                slot_id[vec.index_of(id)] = id;
+            }
+            std::vector<id_type> expected;
+            for (const std::size_t slot : perm) {
+                if (slot_id[slot] != vector_type::invalid_id) {
+                    expected.push_back(slot_id[slot]);
+                }
+            }
+
+            if constexpr (Parallel) {
+                vec.apply_permutation(siv::execution::par, perm);
+            } else {
+                vec.apply_permutation(perm);
+            }
+            assert(vec.size() == live.size() && vec.slot_count() == live.size());
+            if constexpr (tombstones) {
+                assert(vec.hole_count() == 0);
+            }
+            for (std::size_t i = 0; i < expected.size(); ++i) {
+                assert(vec.index_of(expected[i]) == i);
+                assert(vec.is_live_at(i));
+            }
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                const bool alive = std::find(live.begin(), live.end(), ids[i]) != live.end();
+                assert(vec.contains(ids[i]) == alive);
+                assert(!alive || vec[ids[i]] == i * 3);
+            }
+
+            // The dropped holes are recyclable IDs again
+            for (std::size_t i = live.size(); i < count; ++i) {
+                assert(vec.push_back(0) < count);
+            }
+        }
+    }
+
+    template<typename Traits>
+    void run(std::mt19937& rng)
+    {
+        check<Traits, false>(rng);
+        check<Traits, true>(rng);
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(7);
+    run<siv::default_traits>(rng);
+    run<siv::ordered_traits<>>(rng);
+    run<siv::ordered_traits<siv::relocating_traits<>>>(rng);
+    run<siv::ordered_traits<siv::paged_traits<64>>>(rng);
+    return 0;
+}
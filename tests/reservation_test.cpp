@@ -0,0 +1,240 @@
+// ID reservations under different thread schedules: which thread gets which IDs depends on timing,
+// but the block does not, every ID is claimed once, and the vector built from it in ID order is the
+// same. IDs never constructed go back to the free IDs through release_ids() or the destructor.
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct node
+    {
+        std::uint64_t key    = 0;
+        siv::id_type  parent = siv::vector<node>::invalid_id;
+    };
+
+    /// IDs, generations and keys in data order, and the IDs the next insertions would get
+    struct snapshot
+    {
+        std::vector<siv::id_type>  ids;
+        std::vector<std::uint64_t> generations;
+        std::vector<std::uint64_t> keys;
+        std::vector<siv::id_type>  next_ids;
+
+        bool operator==(const snapshot& other) const
+        {
+            return ids == other.ids && generations == other.generations && keys == other.keys &&
+                   next_ids == other.next_ids;
+        }
+    };
+
+    /// A vector with some erased IDs, so that reservations mix recycled and fresh IDs
+    void populate(siv::vector<node>& vec)
+    {
+        std::vector<siv::id_type> ids;
+        for (std::uint64_t i = 0; i < 200; ++i) {
+            ids.push_back(vec.push_back(node{i}));
+        }
+        for (std::size_t i = 0; i < ids.size(); i += 3) {
+            vec.erase(ids[i]);
+        }
+    }
+
+    snapshot take_snapshot(siv::vector<node>& vec)
+    {
+        snapshot s;
+        vec.for_each([&](siv::id_type id, const node& n) {
+            s.ids.push_back(id);
+            s.generations.push_back(static_cast<std::uint64_t>(vec.generation(id)));
+            s.keys.push_back(n.key);
+        });
+        // Probe the free IDs, then put the vector back as it was
+        for (int i = 0; i < 100; ++i) {
+            s.next_ids.push_back(vec.push_back(node{}));
+        }
+        for (const siv::id_type id : s.next_ids) {
+            vec.erase(id);
+        }
+        return s;
+    }
+
+    enum class schedule
+    {
+        concurrent,    ///< All threads claim at once
+        reversed,      ///< One thread after the other, the last one first
+        interleaved,   ///< At once, yielding between claims
+    };
+
+    constexpr int         thread_count = 4;
+    constexpr std::size_t block_size   = 3000;
+
+    /** Threads claim chains of 1 to 4 IDs until the block runs out; each chain links its nodes to
+     *  their predecessor before any exists. The owner then constructs them in ID order.
+     */
+    snapshot run(schedule mode)
+    {
+        siv::vector<node> vec;
+        populate(vec);
+        auto block = vec.reserve_ids(block_size);
+        assert(block.size() == block_size && block.claimed() == 0);
+
+        std::vector<std::vector<siv::span<const siv::id_type>>> chains(thread_count);
+        auto claim_all = [&](int t) {
+            for (std::size_t n = 1 + static_cast<std::size_t>(t) % 4;; n = n % 4 + 1) {
+                const siv::span<const siv::id_type> chain = block.claim(n);
+                if (chain.empty()) {
+                    // Another thread may still fit a shorter chain; take what is left one by one
+                    if (block.claimed() == block.size()) {
+                        break;
+                    }
+                    continue;
+                }
+                chains[t].push_back(chain);
+                if (mode == schedule::interleaved) {
+                    std::this_thread::yield();
+                }
+            }
+        };
+        if (mode == schedule::reversed) {
+            for (int t = thread_count - 1; t >= 0; --t) {
+                std::thread(claim_all, t).join();
+            }
+        } else {
+            std::atomic<bool> start{false};
+            std::vector<std::thread> threads;
+            for (int t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&, t] {
+                    while (!start.load()) {
+                        std::this_thread::yield();
+                    }
+                    claim_all(t);
+                });
+            }
+            start.store(true);
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+        }
+
+        // Each ID of the block was claimed exactly once, as consecutive block entries
+        std::vector<siv::id_type> claimed;
+        for (const auto& thread_chains : chains) {
+            for (const auto& chain : thread_chains) {
+                assert(std::is_sorted(chain.begin(), chain.end()));
+                claimed.insert(claimed.end(), chain.begin(), chain.end());
+            }
+        }
+        std::sort(claimed.begin(), claimed.end());
+        assert(claimed.size() == block_size);
+        assert(std::adjacent_find(claimed.begin(), claimed.end()) == claimed.end());
+        assert(block.claim() == siv::vector<node>::invalid_id);
+        for (const siv::id_type id : claimed) {
+            assert(!vec.contains(id));
+        }
+
+        // The parent of each node is the previous ID of its chain
+        std::vector<siv::id_type> parent(claimed.back() + 1, siv::vector<node>::invalid_id);
+        for (const auto& thread_chains : chains) {
+            for (const auto& chain : thread_chains) {
+                for (std::size_t i = 1; i < chain.size(); ++i) {
+                    parent[chain[i]] = chain[i - 1];
+                }
+            }
+        }
+        for (const siv::id_type id : claimed) {
+            vec.emplace_reserved(block, id, node{1000 + id, parent[id]});
+        }
+        for (const siv::id_type id : claimed) {
+            const node& n = vec[id];
+            assert(n.key == 1000 + id);
+            assert(n.parent == siv::vector<node>::invalid_id || (n.parent < id && vec.contains(n.parent)));
+        }
+        return take_snapshot(vec);
+    }
+
+    /// release_ids() and the destructor return exactly the IDs that were never constructed
+    void release_unclaimed()
+    {
+        // No free IDs to begin with, so that the reused IDs below can only come from the reservations
+        siv::vector<node> vec;
+        for (std::uint64_t i = 0; i < 50; ++i) {
+            (void)vec.push_back(node{i});
+        }
+
+        std::vector<siv::id_type> unused;
+        {
+            auto block = vec.reserve_ids(10);
+            const siv::span<const siv::id_type> first = block.claim(4);
+            std::vector<siv::id_type> all(first.begin(), first.end());
+            while (true) {
+                const siv::id_type id = block.claim();
+                if (id == siv::vector<node>::invalid_id) {
+                    break;
+                }
+                all.push_back(id);
+            }
+            assert(all.size() == 10 && block.claimed() == 10);
+            // Construct two of the claimed IDs; the other eight stay reserved
+            vec.emplace_reserved(block, all[1], node{1});
+            vec.emplace_reserved(block, all[6], node{6});
+            for (std::size_t i = 0; i < all.size(); ++i) {
+                if (i != 1 && i != 6) {
+                    unused.push_back(all[i]);
+                }
+            }
+            // No insertion takes a reserved ID
+            const siv::id_type other = vec.push_back(node{});
+            assert(other == 60);
+            vec.erase(other);
+            unused.push_back(other);
+
+            vec.release_ids(block);
+            assert(block.size() == 0 && block.claimed() == 0 && block.claim() == siv::vector<node>::invalid_id);
+            for (const siv::id_type id : unused) {
+                assert(!vec.contains(id));
+            }
+        }
+        assert(vec.size() == 52);
+
+        // The eight unused IDs are free again, next to the one erased above, and nothing else is
+        std::vector<siv::id_type> reused;
+        for (std::size_t i = 0; i < unused.size(); ++i) {
+            reused.push_back(vec.push_back(node{}));
+        }
+        std::sort(unused.begin(), unused.end());
+        std::sort(reused.begin(), reused.end());
+        assert(reused == unused);
+        assert(vec.next_id() == 61);
+
+        // The destructor releases a block whose IDs were claimed but never constructed
+        std::vector<siv::id_type> dropped;
+        {
+            auto block = vec.reserve_ids(5);
+            const siv::span<const siv::id_type> all = block.claim(5);
+            dropped.assign(all.begin(), all.end());
+        }
+        std::vector<siv::id_type> again;
+        for (int i = 0; i < 5; ++i) {
+            again.push_back(vec.push_back(node{}));
+        }
+        std::sort(again.begin(), again.end());
+        assert(again == dropped && vec.next_id() == 66);
+    }
+}
+
+int main()
+{
+    const snapshot reference = run(schedule::reversed);
+    for (int r = 0; r < 5; ++r) {
+        assert(run(schedule::concurrent) == reference);
+        assert(run(schedule::interleaved) == reference);
+    }
+    release_unclaimed();
+    return 0;
+}
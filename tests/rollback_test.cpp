@@ -0,0 +1,228 @@
+// Regression tests for insertions into siv::vector and siv::soa_vector whose element construction
+// throws, and for batch erasures whose element moves throw
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    /// Copying throws once the countdown reaches zero
+    struct fragile
+    {
+        static inline int countdown = -1;
+
+        int value = 0;
+
+        explicit fragile(int v) : value(v) {}
+
+        fragile(const fragile& other) : value(other.value)
+        {
+            if (countdown >= 0 && countdown-- == 0) {
+                throw std::runtime_error("copy failed");
+            }
+        }
+
+        fragile& operator=(const fragile&) = default;
+    };
+
+    /// A throwing soa_vector::emplace_back() gives its recycled ID back too
+    template<siv::recycle_policy Mode>
+    void soa_emplace_keeps_free_ids()
+    {
+        using vector = siv::basic_soa_vector<std::allocator<std::byte>, siv::recycling_traits<Mode>, int, fragile>;
+        vector vec;
+        std::vector<typename vector::id_type> ids;
+        for (int i = 0; i < 10; ++i) {
+            ids.push_back(vec.emplace_back(i, fragile{i}));
+        }
+        for (const auto id : ids) {
+            vec.erase(id);
+        }
+
+        const fragile value{42};
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            fragile::countdown = 0;
+            try {
+                (void)vec.emplace_back(attempt, value);
+            } catch (const std::runtime_error&) {
+            }
+        }
+        fragile::countdown = -1;
+        assert(vec.empty());
+
+        for (int i = 0; i < 10; ++i) {
+            const auto id = vec.emplace_back(i, fragile{i});
+            assert(id < 10);
+        }
+        assert(vec.emplace_back(10, fragile{10}) == 10);
+    }
+
+    /// Move assignment throws when it moves the value `poison`
+    struct brittle
+    {
+        static inline int poison = -1;
+
+        int value = 0;
+
+        explicit brittle(int v) : value(v) {}
+
+        brittle(const brittle&) = default;
+        brittle(brittle&&)      = default;
+
+        brittle& operator=(const brittle&) = default;
+
+        brittle& operator=(brittle&& other)
+        {
+            if (other.value == poison) {
+                throw std::runtime_error("move failed");
+            }
+            value = other.value;
+            return *this;
+        }
+    };
+
+    /// An erase_if() whose survivor move throws keeps that survivor, and the matched element too
+    template<siv::recycle_policy Mode>
+    void throwing_move_keeps_survivors()
+    {
+        using vector = siv::vector<brittle, std::allocator<brittle>, siv::recycling_traits<Mode>>;
+        vector vec;
+        std::vector<typename vector::id_type> ids;
+        for (int i = 0; i < 4; ++i) {
+            ids.push_back(vec.emplace_back(i));
+        }
+
+        // The last survivor is moved into the hole of 0 and throws
+        brittle::poison = 3;
+        bool thrown = false;
+        try {
+            vec.erase_if([](const brittle& b) { return b.value == 0; });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(vec.size() == 4);
+        for (int i = 0; i < 4; ++i) {
+            assert(vec.contains(ids[i]) && vec[ids[i]].value == i);
+        }
+
+        // Holes already filled before the throw stay erased; the rest stays live
+        vec.erase_if([](const brittle& b) { return b.value == 3; });
+        for (int i = 10; i < 16; ++i) {
+            ids.push_back(vec.emplace_back(i));
+        }
+        brittle::poison = 14;
+        thrown = false;
+        try {
+            vec.erase_if([](const brittle& b) { return b.value < 2; });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        brittle::poison = -1;
+        assert(thrown);
+        // 15 filled the hole of 0 before 14 failed to fill the hole of 1
+        assert(!vec.contains(ids[0]));
+        assert(vec.contains(ids[1]) && vec[ids[1]].value == 1);
+        for (std::size_t i = 2; i < ids.size(); ++i) {
+            if (i != 3) {
+                assert(vec.contains(ids[i]) && vec[ids[i]].value == (i < 4 ? static_cast<int>(i) : static_cast<int>(i) + 6));
+            }
+        }
+        assert(vec.size() == 8);
+        std::size_t live = 0;
+        vec.for_each([&](typename vector::id_type id, const brittle& b) {
+            assert(vec[id].value == b.value);
+            ++live;
+        });
+        assert(live == vec.size());
+
+        // The released IDs are recycled, the others are not
+        const auto recycled = vec.emplace_back(99);
+        assert(recycled == ids[0] || recycled == ids[3]);
+    }
+
+    /// A throwing emplace_n() leaves no element behind and loses no free ID
+    template<siv::recycle_policy Mode>
+    void rollback_keeps_free_ids()
+    {
+        using vector = siv::vector<fragile, std::allocator<fragile>, siv::recycling_traits<Mode>>;
+        vector vec;
+        std::vector<typename vector::id_type> ids;
+        for (int i = 0; i < 10; ++i) {
+            ids.push_back(vec.emplace_back(i));
+        }
+        for (const auto id : ids) {
+            vec.erase(id);
+        }
+
+        fragile::countdown = 3;
+        bool thrown = false;
+        try {
+            vec.emplace_n(8, {}, fragile{42});
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        fragile::countdown = -1;
+        assert(thrown);
+        assert(vec.empty());
+
+        // All ten free IDs are recycled before any fresh one is created
+        for (int i = 0; i < 10; ++i) {
+            const auto id = vec.emplace_back(i);
+            assert(id < 10);
+        }
+        assert(vec.size() == 10);
+        assert(vec.emplace_back(10) == 10);
+    }
+
+    /// A throwing push_back() gives its recycled ID back
+    template<siv::recycle_policy Mode>
+    void push_back_keeps_free_ids()
+    {
+        using vector = siv::vector<fragile, std::allocator<fragile>, siv::recycling_traits<Mode>>;
+        vector vec;
+        std::vector<typename vector::id_type> ids;
+        for (int i = 0; i < 10; ++i) {
+            ids.push_back(vec.emplace_back(i));
+        }
+        for (const auto id : ids) {
+            vec.erase(id);
+        }
+
+        const fragile value{42};
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            fragile::countdown = 0;
+            try {
+                (void)vec.push_back(value);
+            } catch (const std::runtime_error&) {
+            }
+        }
+        fragile::countdown = -1;
+        assert(vec.empty());
+
+        for (int i = 0; i < 10; ++i) {
+            const auto id = vec.emplace_back(i);
+            assert(id < 10);
+        }
+    }
+}
+
+int main()
+{
+    rollback_keeps_free_ids<siv::recycle_policy::lifo>();
+    rollback_keeps_free_ids<siv::recycle_policy::fifo>();
+    rollback_keeps_free_ids<siv::recycle_policy::lowest_id>();
+    push_back_keeps_free_ids<siv::recycle_policy::lifo>();
+    push_back_keeps_free_ids<siv::recycle_policy::fifo>();
+    push_back_keeps_free_ids<siv::recycle_policy::lowest_id>();
+    soa_emplace_keeps_free_ids<siv::recycle_policy::lifo>();
+    soa_emplace_keeps_free_ids<siv::recycle_policy::fifo>();
+    soa_emplace_keeps_free_ids<siv::recycle_policy::lowest_id>();
+    throwing_move_keeps_survivors<siv::recycle_policy::lifo>();
+    throwing_move_keeps_survivors<siv::recycle_policy::fifo>();
+    throwing_move_keeps_survivors<siv::recycle_policy::lowest_id>();
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Regression tests for shrink_to_fit() with narrow generation counters
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // 16-bit IDs, 4-bit generations: an ID retires after a handful of reuses
+    using narrow_traits = siv::basic_traits<16, 4>;
+    using narrow_vector = siv::vector<int, std::allocator<int>, narrow_traits>;
+
+    using key = std::pair<narrow_vector::id_type, narrow_vector::generation_type>;
+
+    /// Inserts and erases one element per round, optionally shrinking after each erase.
+    /// Every handle ever made must stay invalid once its element is gone.
+    narrow_vector::size_type churn(int rounds, bool shrink)
+    {
+        narrow_vector vec;
+        std::vector<key> stale;
+        for (int round = 0; round < rounds; ++round) {
+            const auto id = vec.push_back(round);
+            stale.emplace_back(id, vec.generation(id));
+            vec.erase(id);
+            if (shrink) {
+                vec.shrink_to_fit();
+            }
+            for (const key& k : stale) {
+                assert(!vec.is_valid(k.first, k.second));
+            }
+        }
+        return vec.retired_count();
+    }
+
+    /// Releasing a worn-out ID must not age the IDs created after it
+    void fresh_ids_start_low()
+    {
+        narrow_vector vec;
+        const auto kept = vec.push_back(0);
+        auto hot = vec.push_back(1);
+        for (int i = 0; i < 5; ++i) {
+            vec.erase(hot);
+            hot = vec.push_back(1);
+        }
+        const auto hot_generation = vec.generation(hot);
+        assert(hot_generation > 5);
+        vec.erase(hot);
+        vec.shrink_to_fit();
+        assert(vec.contains(kept));
+
+        // The released ID comes back above its last generation, a new one starts from zero
+        const auto reborn = vec.push_back(2);
+        assert(reborn == hot);
+        assert(vec.generation(reborn) > hot_generation);
+        const auto fresh = vec.push_back(3);
+        assert(vec.generation(fresh) == 0);
+        assert(vec.generation(kept) == 0);
+    }
+}
+
+int main()
+{
+    // Shrinking after every erase retires IDs no faster than plain recycling
+    const int rounds = 2000;
+    const auto recycled = churn(rounds, false);
+    const auto shrunk   = churn(rounds, true);
+    assert(shrunk <= recycled + 1);
+
+    fresh_ids_start_low();
+    return 0;
+}
@@ -0,0 +1,210 @@
+// Bulk handle validation against is_valid(): every instruction set, ragged lengths, stale,
+// foreign and out-of-range handles, and handle_set::sweep()
+#undef NDEBUG
+#include "index_vector.hpp"
+
+#include <cassert>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    struct colocated_compact_traits : siv::compact_traits
+    {
+        static constexpr bool colocated_generation = true;
+    };
+
+    struct colocated_default_traits : siv::default_traits
+    {
+        static constexpr bool colocated_generation = true;
+    };
+
+    /// Every instruction set the running CPU supports, the scalar loop first
+    std::vector<siv::detail::simd_isa> supported_isas()
+    {
+        using siv::detail::simd_isa;
+        const simd_isa detected = siv::detail::detected_simd_isa();
+        std::vector<simd_isa> isas{simd_isa::scalar};
+        if (detected == simd_isa::avx2 || detected == simd_isa::avx512) {
+            isas.push_back(simd_isa::avx2);
+        }
+        if (detected == simd_isa::avx512) {
+            isas.push_back(simd_isa::avx512);
+        }
+        return isas;
+    }
+
+    /// id_table::validate() on every instruction set and every length matches is_valid() pair by pair
+    template<typename Traits>
+    void check_table(std::mt19937& rng)
+    {
+        using table_type      = siv::detail::id_table<Traits, std::allocator<int>>;
+        using id_type         = typename table_type::id_type;
+        using generation_type = typename table_type::generation_type;
+
+        table_type table;
+        std::size_t size = 0;
+        for (int i = 0; i < 300; ++i) {
+            table.acquire(size++);
+        }
+        // Erase and refill a few rounds, so that generations differ from ID to ID
+        for (int round = 0; round < 4; ++round) {
+            for (int i = 0; i < 120; ++i) {
+                table.release(table.rid(rng() % size), size);
+                --size;
+            }
+            for (int i = 0; i < 60; ++i) {
+                table.acquire(size++);
+            }
+        }
+
+        std::vector<id_type> ids;
+        std::vector<generation_type> generations;
+        auto add = [&](id_type id, generation_type generation) {
+            ids.push_back(id);
+            generations.push_back(generation);
+        };
+        const std::size_t id_count = size + 200;
+        for (std::size_t id = 0; id < id_count; ++id) {
+            const auto gen = id < table.index_count() ? table.generation(static_cast<id_type>(id)) : generation_type{0};
+            add(static_cast<id_type>(id), gen);
+            add(static_cast<id_type>(id), static_cast<generation_type>(gen + 1));
+            add(static_cast<id_type>(id), static_cast<generation_type>(gen - 1));
+        }
+        // Out of range: past the table, the invalid ID and the widest values of the types
+        add(static_cast<id_type>(table.index_count()), 0);
+        add(static_cast<id_type>(table.index_count() + 1000), 0);
+        add(table_type::invalid_id, 0);
+        add(std::numeric_limits<id_type>::max(), 0);
+        add(std::numeric_limits<id_type>::max(), std::numeric_limits<generation_type>::max());
+        add(static_cast<id_type>(std::numeric_limits<id_type>::max() / 2 + 1), 0);
+        // Shuffle so that valid and invalid pairs mix within every register
+        for (std::size_t i = ids.size(); i > 1; --i) {
+            const std::size_t j = rng() % i;
+            std::swap(ids[i - 1], ids[j]);
+            std::swap(generations[i - 1], generations[j]);
+        }
+
+        std::vector<bool> expected(ids.size());
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            expected[i] = table.is_valid(ids[i], generations[i], size);
+        }
+
+        std::unique_ptr<bool[]> out(new bool[ids.size()]);
+        for (const auto isa : supported_isas()) {
+            // Ragged lengths around every lane count, at unaligned offsets
+            for (std::size_t n = 0; n <= 70; ++n) {
+                for (std::size_t first : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{13}}) {
+                    std::size_t expected_valid = 0;
+                    for (std::size_t i = 0; i < n; ++i) {
+                        out[i] = !expected[first + i];
+                        expected_valid += expected[first + i] ? 1 : 0;
+                    }
+                    const auto valid = table.validate(ids.data() + first, generations.data() + first, n, size, out.get(), isa);
+                    assert(valid == expected_valid);
+                    for (std::size_t i = 0; i < n; ++i) {
+                        assert(out[i] == expected[first + i]);
+                    }
+                }
+            }
+            // The whole set at once
+            const auto valid = table.validate(ids.data(), generations.data(), ids.size(), size, out.get(), isa);
+            std::size_t expected_valid = 0;
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                assert(out[i] == expected[i]);
+                expected_valid += expected[i] ? 1 : 0;
+            }
+            assert(valid == expected_valid);
+        }
+    }
+
+    /// vector::validate() and handle_set::sweep() agree with handle::valid(); handles of another
+    /// vector count as invalid
+    template<typename Traits>
+    void check_vector(std::mt19937& rng)
+    {
+        using vector_type = siv::vector<int, std::allocator<int>, Traits>;
+        using handle_type = typename vector_type::handle_type;
+
+        vector_type vec;
+        vector_type other;
+        std::vector<handle_type> handles;
+        std::vector<bool> own;
+        for (int i = 0; i < 500; ++i) {
+            handles.push_back(vec.make_handle(vec.push_back(i)));
+            own.push_back(true);
+            if (i % 3 == 0) {
+                // Same IDs and generations in another vector
+                handles.push_back(other.make_handle(other.push_back(i)));
+                own.push_back(false);
+            }
+        }
+        for (int i = 0; i < 200; ++i) {
+            vec.erase_at(rng() % vec.size());
+        }
+        for (int i = 0; i < 100; ++i) {
+            handles.push_back(vec.make_handle(vec.push_back(i)));
+            own.push_back(true);
+        }
+
+        std::vector<bool> expected(handles.size());
+        std::size_t expected_valid = 0;
+        for (std::size_t i = 0; i < handles.size(); ++i) {
+            expected[i] = own[i] && handles[i].valid();
+            expected_valid += expected[i] ? 1 : 0;
+        }
+        assert(expected_valid > 0 && expected_valid < handles.size());
+
+        std::unique_ptr<bool[]> out(new bool[handles.size()]);
+        for (std::size_t n : {std::size_t{0}, std::size_t{5}, std::size_t{255}, std::size_t{256}, std::size_t{257}, handles.size()}) {
+            std::size_t valid_prefix = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                valid_prefix += expected[i] ? 1 : 0;
+            }
+            const auto valid = vec.validate(siv::span<const handle_type>(handles.data(), n), siv::span<bool>(out.get(), n));
+            assert(valid == valid_prefix);
+            for (std::size_t i = 0; i < n; ++i) {
+                assert(out[i] == expected[i]);
+            }
+        }
+
+        siv::handle_set<int, std::allocator<int>, Traits> set(vec);
+        for (const handle_type& h : handles) {
+            set.insert(h);
+        }
+        const auto removed = set.sweep();
+        assert(removed == handles.size() - expected_valid);
+        assert(set.size() == expected_valid);
+        // Survivors keep their order
+        auto it = set.begin();
+        for (std::size_t i = 0; i < handles.size(); ++i) {
+            if (expected[i]) {
+                assert(it != set.end() && it->id() == handles[i].id() && it->generation() == handles[i].generation());
+                ++it;
+            }
+        }
+        assert(it == set.end());
+        assert(set.sweep() == 0);
+    }
+
+    template<typename Traits>
+    void check(std::mt19937& rng)
+    {
+        check_table<Traits>(rng);
+        check_vector<Traits>(rng);
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+    // 8-byte lanes, 4-byte lanes, both co-located, and a packed layout that always runs the scalar loop
+    check<siv::default_traits>(rng);
+    check<siv::compact_traits>(rng);
+    check<colocated_default_traits>(rng);
+    check<colocated_compact_traits>(rng);
+    check<siv::basic_traits<20, 12>>(rng);
+    return 0;
+}